@@ -0,0 +1,177 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: arena.h
+// DATE: Oct 16, 2026
+// DESC: Bump allocator that owns every node of a parsed program, and
+//       the spans used for the node's child sequences. Nodes are
+//       allocated back to back in large blocks and are never freed one
+//       at a time: destroying the arena releases all of them at once
+//       (so the nodes must not own any memory themselves).
+//----------------------------------------------------------------------
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+//----------------------------------------------------------------------
+// A contiguous sequence of items held by an arena (or empty). Spans
+// are plain views, so copying one does not copy the items.
+//----------------------------------------------------------------------
+template<typename T>
+class Span
+{
+public:
+
+  Span() : items(nullptr), count(0) {}
+  Span(T* items, size_t count) : items(items), count(count) {}
+
+  T* begin() const {return items;}
+  T* end() const {return items + count;}
+  size_t size() const {return count;}
+  bool empty() const {return count == 0;}
+  T& front() const {return items[0];}
+  T& back() const {return items[count - 1];}
+  T& operator[](size_t i) const {return items[i];}
+
+private:
+  T* items;
+  size_t count;
+};
+
+
+class Arena
+{
+public:
+
+  // create an empty arena that grabs memory block_size bytes at a time
+  Arena(size_t block_size = 1 << 16);
+
+  // free every block (and with them every node)
+  ~Arena();
+
+  // nodes point into the arena, so it is never copied
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  //----------------------------------------------------------------------
+  // Return uninitialized memory that lives as long as the arena.
+  // Inputs:
+  //   size -- the number of bytes
+  //   align -- the alignment (a power of two)
+  //----------------------------------------------------------------------
+  void* allocate(size_t size, size_t align);
+
+  // construct a new object in the arena
+  template<typename T, typename... Args>
+  T* make(Args&&... args);
+
+  // copy the items into a new span in the arena
+  template<typename T>
+  Span<T> copy(const std::vector<T>& items);
+
+  // a new span of count copies of value
+  template<typename T>
+  Span<T> fill(size_t count, const T& value);
+
+  // the number of bytes handed out so far
+  size_t bytes_used() const;
+
+private:
+  std::vector<char*> blocks;
+  char* next;                   // next free byte in the current block
+  char* limit;                  // end of the current block
+  size_t block_size;
+  size_t used;
+};
+
+
+Arena::Arena(size_t block_size)
+  : next(nullptr), limit(nullptr), block_size(block_size), used(0)
+{
+}
+
+
+Arena::~Arena()
+{
+  for (char* block : blocks)
+    std::free(block);
+}
+
+
+void* Arena::allocate(size_t size, size_t align)
+{
+  size_t pad = (align - reinterpret_cast<size_t>(next) % align) % align;
+  if (!next or pad + size > static_cast<size_t>(limit - next)) {
+    // large requests get a block of their own (keeping the current one)
+    size_t bytes = size + align > block_size / 4 ? size + align : block_size;
+    char* block = static_cast<char*>(std::malloc(bytes));
+    if (!block)
+      throw std::bad_alloc();
+    blocks.push_back(block);
+    if (bytes != block_size and next) {
+      size_t offset = (align - reinterpret_cast<size_t>(block) % align) % align;
+      used += size;
+      return block + offset;
+    }
+    next = block;
+    limit = block + bytes;
+    pad = (align - reinterpret_cast<size_t>(next) % align) % align;
+  }
+  char* p = next + pad;
+  next = p + size;
+  used += size;
+  return p;
+}
+
+
+template<typename T, typename... Args>
+T* Arena::make(Args&&... args)
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "arena objects are freed without running destructors");
+  return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+
+template<typename T>
+Span<T> Arena::copy(const std::vector<T>& items)
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "arena objects are freed without running destructors");
+  if (items.empty())
+    return Span<T>();
+  T* p = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+  for (size_t i = 0; i < items.size(); ++i)
+    new (p + i) T(items[i]);
+  return Span<T>(p, items.size());
+}
+
+
+template<typename T>
+Span<T> Arena::fill(size_t count, const T& value)
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "arena objects are freed without running destructors");
+  if (count == 0)
+    return Span<T>();
+  T* p = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+  for (size_t i = 0; i < count; ++i)
+    new (p + i) T(value);
+  return Span<T>(p, count);
+}
+
+
+size_t Arena::bytes_used() const
+{
+  return used;
+}
+
+
+#endif
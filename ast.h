@@ -5,15 +5,20 @@
 // DESC: AST types for MyPL implementation. Each AST node is
 //       implemented as POD (plain old data) types, with all data
 //       public, with the exception of the visitor abstraction (i.e.,
-//       the accept function) and a destrutor for dynamic memory. Note
-//       that some liberties are taken with formatting to keep the
-//       file size manageable.
+//       the accept function). Every node of a program is allocated in
+//       the program's arena and child sequences are arena spans, so
+//       nodes have no destructors and the whole tree is freed at once
+//       with the program. Note that some liberties are taken with
+//       formatting to keep the file size manageable.
 //----------------------------------------------------------------------
 
 #ifndef AST_H
 #define AST_H
 
-#include <list>
+#include <memory>
+#include <string>
+#include "arena.h"
+#include "source_buffer.h"
 
 //----------------------------------------------------------------------
 // Visitor interface
@@ -67,15 +72,24 @@ public:
 };
 
 
+//----------------------------------------------------------------------
+// Variable locations (filled in by the resolver)
+//----------------------------------------------------------------------
+
+// a variable is found by moving depth scopes out from the current
+// scope and taking the slot-th variable declared in that scope
+struct VarSlot {int depth = -1; int slot = -1;};
+
+
 //----------------------------------------------------------------------
 // Top-level Abstract AST Nodes
 //----------------------------------------------------------------------
 
-// root AST node interface
+// root AST node interface (nodes are never deleted through it, see
+// Arena)
 class ASTNode
 {
 public:
-  virtual ~ASTNode() {};
   virtual void accept(Visitor& v) = 0;
 };
 
@@ -97,6 +111,8 @@ class ExprTerm : public ASTNode
 {
 public:
   virtual Token first_token() = 0;
+  // the expression the term wraps (if any)
+  virtual Expr* nested_expr() {return nullptr;}
 };
 
 // root rhs value node
@@ -119,10 +135,12 @@ public:
   ExprTerm* first = nullptr;    // the first term
   Token* op = nullptr;          // optional operator
   Expr* rest = nullptr;         // expression after operator (if exists)
-  // cleanup
-  ~Expr() {delete first; delete op; delete rest;}
   // get first token
   Token first_token() {return first->first_token();}
+  // the left operand of a binary expression if it is itself an
+  // expression (the parser nests chains of operators this way, so
+  // passes can walk a long chain with a loop instead of recursion)
+  Expr* left_expr() {return negated or !op ? nullptr : first->nested_expr();}
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -132,8 +150,6 @@ class SimpleTerm : public ExprTerm
 {
 public:
   RValue* rvalue = nullptr;     // one rvalue ("base case")
-  // cleanup memory
-  ~SimpleTerm() {delete rvalue;}
   // return first token
   Token first_token() {return rvalue->first_token();}  
   // visitor access
@@ -145,10 +161,10 @@ class ComplexTerm : public ExprTerm
 {
 public:
   Expr* expr = nullptr;         // term is another expression
-  // cleanup memory
-  ~ComplexTerm() {delete expr;}
   // return first token
   Token first_token() {return expr->first->first_token();}  
+  // return the wrapped expression
+  Expr* nested_expr() {return expr;}
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -162,9 +178,9 @@ public:
 class Program : public ASTNode
 {
 public:
-  std::list<Decl*> decls;       //  list of declarations
-  // cleanup memory
-  ~Program() {for (Decl* d : decls) delete d;}
+  Span<Decl*> decls;            //  list of declarations
+  std::shared_ptr<SourceBuffer> source;  // text the token lexemes refer to
+  Arena arena;                  // owns every node of the program
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -176,10 +192,8 @@ public:
   struct FunParam {Token id; Token type;}; // function parameter type
   Token return_type;                       // function return type
   Token id;                                // function name
-  std::list<FunParam> params;              // function params
-  std::list<Stmt*> stmts;                  // function body 
-  // cleanup memory
-  ~FunDecl() {for (Stmt* s : stmts) delete s;}
+  Span<FunParam> params;                   // function params
+  Span<Stmt*> stmts;                       // function body 
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -191,8 +205,7 @@ public:
   Token* type = nullptr;        // optional variable type
   Token id;                     // variable name
   Expr* expr = nullptr;         // variable initialization expression
-  // cleanup memory
-  ~VarDeclStmt() {delete type; delete expr;}
+  VarSlot var;                  // location of the declared variable
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -202,9 +215,7 @@ class TypeDecl : public Decl
 {
 public:
   Token id;                       // type name
-  std::list<VarDeclStmt*> vdecls; // variable declarations
-  // cleanup memory
-  ~TypeDecl() {for (VarDeclStmt* v : vdecls) delete v;}
+  Span<VarDeclStmt*> vdecls;      // variable declarations
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -218,10 +229,10 @@ public:
 class AssignStmt : public Stmt
 {
 public:
-  std::list<Token> lvalue_list; // lhs as one or more ids
+  Span<Token> lvalue_list;      // lhs as one or more ids
   Expr* expr = nullptr;         // rhs expression
-  // cleanup memory
-  ~AssignStmt() {delete expr;}
+  VarSlot var;                  // location of the first lhs id
+  Span<int> fields;             // field offsets of the remaining ids
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -231,8 +242,6 @@ class ReturnStmt : public Stmt
 {
 public:
   Expr* expr = nullptr;         // return expression
-  // cleanup memory
-  ~ReturnStmt() {delete expr;}
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -243,9 +252,7 @@ class BasicIf
 {
 public:
   Expr* expr = nullptr;   // boolean expression
-  std::list<Stmt*> stmts; // body statements
-  // cleanup memory
-  ~BasicIf() {delete expr; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;      // body statements
 };
 
 
@@ -253,17 +260,8 @@ class IfStmt : public Stmt
 {
 public:
   BasicIf* if_part = nullptr;   // if part
-  std::list<BasicIf*> else_ifs; // else ifs
-  std::list<Stmt*> body_stmts;  // else body (if empty, no else)
-  // cleanup memory
-  ~IfStmt()
-  {
-    delete if_part;
-    for (BasicIf* s : else_ifs)
-      delete s;
-    for (Stmt* s : body_stmts)
-      delete s;
-  }
+  Span<BasicIf*> else_ifs;      // else ifs
+  Span<Stmt*> body_stmts;       // else body (if empty, no else)
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -273,9 +271,7 @@ class WhileStmt : public Stmt
 {
 public:
   Expr* expr = nullptr;         // boolean expression
-  std::list<Stmt*> stmts;       // body statements
-  // cleanup memory
-  ~WhileStmt() {delete expr; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;            // body statements
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -285,11 +281,10 @@ class ForStmt : public Stmt
 {
 public:
   Token var_id;                 // loop variable
+  VarSlot var;                  // location of the loop variable
   Expr* start;                  // loop start expression
   Expr* end;                    // loop end expression
-  std::list<Stmt*> stmts;       // loop body
-  // cleanup memory
-  ~ForStmt() {delete start; delete end; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;            // loop body
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -304,6 +299,18 @@ class SimpleRValue : public RValue
 {
 public:
   Token value;                  // primitive value
+  // the value of an int, double, bool, or char literal, converted from
+  // the lexeme once (by parse) instead of on every evaluation
+  bool parsed = false;
+  union {int int_val; double double_val; bool bool_val; char char_val;};
+  // convert the lexeme (throws the std::stoi and std::stod errors)
+  void parse() {
+    if (value.type() == INT_VAL) int_val = std::stoi(value.lexeme());
+    else if (value.type() == DOUBLE_VAL) double_val = std::stod(value.lexeme());
+    else if (value.type() == BOOL_VAL) bool_val = value.lexeme() == "true";
+    else if (value.type() == CHAR_VAL) char_val = value.lexeme().at(0);
+    parsed = true;
+  }
   // return first token
   Token first_token() {return value;}  
   // visitor access
@@ -326,9 +333,8 @@ class CallExpr : public RValue, public Stmt
 {
 public:
   Token function_id;            // function name being called
-  std::list<Expr*> arg_list;    // call arguments
-  // cleanup memory
-  ~CallExpr() {for(Expr* e : arg_list) delete e;}
+  Span<Expr*> arg_list;         // call arguments
+  bool tail = false;            // in tail position (set by the resolver)
   // return first token
   Token first_token() {return function_id;}  
   // visitor access
@@ -339,7 +345,9 @@ public:
 class IDRValue : public RValue
 {
 public:
-  std::list<Token> path;        // one or more ids (path expression)
+  Span<Token> path;             // one or more ids (path expression)
+  VarSlot var;                  // location of the first path id
+  Span<int> fields;             // field offsets of the remaining ids
   // return first token
   Token first_token() {return path.front();}  
   // visitor access
@@ -351,8 +359,6 @@ class NegatedRValue : public RValue
 {
 public:
   Expr* expr = nullptr;         // negated expression
-  // cleanup memory
-  ~NegatedRValue() {delete expr;}
   // return first token
   Token first_token() {return expr->first->first_token();}  
   // visitor access
@@ -0,0 +1,913 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: ast_cache.h
+// DATE: Oct 16, 2026
+// DESC: Binary cache of checked programs, so running an unchanged
+//       script skips lexing, parsing, type checking, and variable
+//       resolution. The checked AST is written to a file named by a
+//       hash of the source text. Loading maps the file and rebuilds
+//       the nodes in the program's arena with two flat passes, and
+//       every token's lexeme points into the mapped file.
+//
+//       File layout (native byte order, checked by the header):
+//         header   -- magic, version, build, source hash and size,
+//                     section sizes, and a hash of the sections
+//         kinds    -- one byte per node (padded to a word boundary)
+//         records  -- 32-bit words: the program's declarations, then
+//                     one record per node in node order, where nodes
+//                     refer to each other by index
+//         strings  -- the lexeme characters the tokens refer to
+//----------------------------------------------------------------------
+
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ast.h"
+#include "byte_scanner.h"
+#include "source_buffer.h"
+
+
+//----------------------------------------------------------------------
+// The 64-bit FNV-1a hash of the bytes from begin up to end.
+//----------------------------------------------------------------------
+uint64_t fnv1a_hash(const char* begin, const char* end);
+
+// the hash of the source text (the cache key)
+uint64_t source_hash(const SourceBuffer& source);
+
+//----------------------------------------------------------------------
+// The cache file for the given source: $MYPL_CACHE_DIR if set, else
+// $XDG_CACHE_HOME/mypl or ~/.cache/mypl, named by the source hash.
+// Returns:
+//   the path, or "" if there is no cache directory
+//----------------------------------------------------------------------
+std::string ast_cache_path(const SourceBuffer& source);
+
+//----------------------------------------------------------------------
+// Load a checked program from the cache.
+// Inputs:
+//   cache_file -- the path from ast_cache_path
+//   source -- the source text the program must have been checked from
+//   program -- an empty program to fill in
+// Returns:
+//   false if there is no usable cache entry (missing, out of date, or
+//   damaged), in which case the program must be checked as usual
+//----------------------------------------------------------------------
+bool load_ast_cache(const std::string& cache_file,
+                    const SourceBuffer& source, Program& program);
+
+//----------------------------------------------------------------------
+// Write a checked program to the cache. The file is written under a
+// temporary name and renamed, so concurrent runs never see a partial
+// entry.
+// Returns:
+//   false if the entry could not be written (the run goes on)
+//----------------------------------------------------------------------
+bool save_ast_cache(Program& program, const SourceBuffer& source,
+                    const std::string& cache_file);
+
+
+//----------------------------------------------------------------------
+// FILE FORMAT
+//----------------------------------------------------------------------
+
+// bump whenever the record layout changes
+const uint32_t AST_CACHE_VERSION = 2;
+
+// entries are only reused by builds of the same front end (the parser
+// and checker may change what a source means). The build system sets
+// the stamp to a hash of the front-end sources, so every target built
+// from them shares one stamp (other builds rely on the version alone).
+#ifndef MYPL_FRONT_END_HASH
+#define MYPL_FRONT_END_HASH ""
+#endif
+const char AST_CACHE_BUILD[] = MYPL_FRONT_END_HASH;
+
+struct AstCacheHeader
+{
+  char magic[8];                // "MYPLAST" and a NUL
+  uint32_t version;             // AST_CACHE_VERSION
+  uint32_t node_count;          // entries in the kinds section
+  char build[24];               // AST_CACHE_BUILD
+  uint64_t source_hash;         // hash of the source text
+  uint64_t source_size;         // bytes of source text
+  uint64_t record_words;        // words in the records section
+  uint64_t string_bytes;        // bytes in the strings section
+  uint64_t payload_hash;        // hash of everything after the header
+};
+
+const char AST_CACHE_MAGIC[8] = "MYPLAST";
+
+// the kind of each node in the kinds section
+enum AstNodeKind {
+  FUN_DECL_NODE, TYPE_DECL_NODE, VAR_DECL_NODE, ASSIGN_NODE, RETURN_NODE,
+  IF_NODE, WHILE_NODE, FOR_NODE, EXPR_NODE, SIMPLE_TERM_NODE,
+  COMPLEX_TERM_NODE, SIMPLE_RVALUE_NODE, NEW_RVALUE_NODE, CALL_NODE,
+  ID_RVALUE_NODE, NEGATED_RVALUE_NODE, NODE_KIND_COUNT
+};
+
+// the index of a missing (null) node
+const uint32_t NO_NODE = 0xFFFFFFFF;
+
+
+//----------------------------------------------------------------------
+// WRITER
+//----------------------------------------------------------------------
+
+// Serializes a program breadth first: a node is given the next index
+// when it is first referred to and its record is written when its turn
+// comes, so deep trees are written with a loop rather than recursion.
+class AstCacheWriter : public Visitor
+{
+public:
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+  // write the file (after visiting the program)
+  bool write(const SourceBuffer& source, const std::string& file_name);
+
+private:
+
+  std::vector<uint8_t> kinds;
+  std::vector<uint32_t> records;
+  std::string strings;
+
+  // nodes waiting for their records (in index order), and the index of
+  // each node by its address
+  std::vector<ASTNode*> pending;
+  std::unordered_map<const void*, uint32_t> indexes;
+
+  // offset of each distinct lexeme in strings
+  std::unordered_map<std::string, uint32_t> string_offsets;
+
+  // record helpers
+  void word(uint32_t w) {records.push_back(w);}
+  void number(int n) {word(static_cast<uint32_t>(n));}
+  void token(const Token& t);
+  void optional_token(const Token* t);
+  void var(const VarSlot& v);
+  void basic_if(const BasicIf& b);
+  template<typename T> void ref(T* node);
+  template<typename T> void refs(const Span<T*>& nodes);
+  void tokens(const Span<Token>& list);
+  void numbers(const Span<int>& list);
+};
+
+
+void AstCacheWriter::token(const Token& t)
+{
+  std::string lexeme = t.lexeme();
+  auto it = string_offsets.find(lexeme);
+  if (it == string_offsets.end()) {
+    it = string_offsets.insert({lexeme, strings.size()}).first;
+    strings += lexeme;
+  }
+  word(t.type());
+  word(it->second);
+  word(lexeme.size());
+  number(t.line());
+  number(t.column());
+}
+
+
+void AstCacheWriter::optional_token(const Token* t)
+{
+  word(t != nullptr);
+  if (t)
+    token(*t);
+}
+
+
+void AstCacheWriter::var(const VarSlot& v)
+{
+  number(v.depth);
+  number(v.slot);
+}
+
+
+void AstCacheWriter::basic_if(const BasicIf& b)
+{
+  ref(b.expr);
+  refs(b.stmts);
+}
+
+
+// write the index of the node, numbering it if it is new
+template<typename T>
+void AstCacheWriter::ref(T* node)
+{
+  if (!node) {
+    word(NO_NODE);
+    return;
+  }
+  // the most derived object identifies the node (a CallExpr is both a
+  // Stmt and an RValue at different addresses)
+  const void* key = dynamic_cast<const void*>(node);
+  auto it = indexes.find(key);
+  if (it == indexes.end()) {
+    it = indexes.insert({key, pending.size()}).first;
+    pending.push_back(node);
+  }
+  word(it->second);
+}
+
+
+template<typename T>
+void AstCacheWriter::refs(const Span<T*>& nodes)
+{
+  word(nodes.size());
+  for (T* node : nodes)
+    ref(node);
+}
+
+
+void AstCacheWriter::tokens(const Span<Token>& list)
+{
+  word(list.size());
+  for (const Token& t : list)
+    token(t);
+}
+
+
+void AstCacheWriter::numbers(const Span<int>& list)
+{
+  word(list.size());
+  for (int n : list)
+    number(n);
+}
+
+
+void AstCacheWriter::visit(Program& node)
+{
+  refs(node.decls);
+  for (size_t i = 0; i < pending.size(); ++i)
+    pending[i]->accept(*this);
+}
+
+
+void AstCacheWriter::visit(FunDecl& node)
+{
+  kinds.push_back(FUN_DECL_NODE);
+  token(node.return_type);
+  token(node.id);
+  word(node.params.size());
+  for (const FunDecl::FunParam& param : node.params) {
+    token(param.id);
+    token(param.type);
+  }
+  refs(node.stmts);
+}
+
+
+void AstCacheWriter::visit(TypeDecl& node)
+{
+  kinds.push_back(TYPE_DECL_NODE);
+  token(node.id);
+  refs(node.vdecls);
+}
+
+
+void AstCacheWriter::visit(VarDeclStmt& node)
+{
+  kinds.push_back(VAR_DECL_NODE);
+  optional_token(node.type);
+  token(node.id);
+  ref(node.expr);
+  var(node.var);
+}
+
+
+void AstCacheWriter::visit(AssignStmt& node)
+{
+  kinds.push_back(ASSIGN_NODE);
+  tokens(node.lvalue_list);
+  ref(node.expr);
+  var(node.var);
+  numbers(node.fields);
+}
+
+
+void AstCacheWriter::visit(ReturnStmt& node)
+{
+  kinds.push_back(RETURN_NODE);
+  ref(node.expr);
+}
+
+
+void AstCacheWriter::visit(IfStmt& node)
+{
+  kinds.push_back(IF_NODE);
+  basic_if(*node.if_part);
+  word(node.else_ifs.size());
+  for (BasicIf* else_if : node.else_ifs)
+    basic_if(*else_if);
+  refs(node.body_stmts);
+}
+
+
+void AstCacheWriter::visit(WhileStmt& node)
+{
+  kinds.push_back(WHILE_NODE);
+  ref(node.expr);
+  refs(node.stmts);
+}
+
+
+void AstCacheWriter::visit(ForStmt& node)
+{
+  kinds.push_back(FOR_NODE);
+  token(node.var_id);
+  var(node.var);
+  ref(node.start);
+  ref(node.end);
+  refs(node.stmts);
+}
+
+
+void AstCacheWriter::visit(Expr& node)
+{
+  kinds.push_back(EXPR_NODE);
+  word(node.negated);
+  ref(node.first);
+  optional_token(node.op);
+  ref(node.rest);
+}
+
+
+void AstCacheWriter::visit(SimpleTerm& node)
+{
+  kinds.push_back(SIMPLE_TERM_NODE);
+  ref(node.rvalue);
+}
+
+
+void AstCacheWriter::visit(ComplexTerm& node)
+{
+  kinds.push_back(COMPLEX_TERM_NODE);
+  ref(node.expr);
+}
+
+
+void AstCacheWriter::visit(SimpleRValue& node)
+{
+  kinds.push_back(SIMPLE_RVALUE_NODE);
+  token(node.value);
+}
+
+
+void AstCacheWriter::visit(NewRValue& node)
+{
+  kinds.push_back(NEW_RVALUE_NODE);
+  token(node.type_id);
+}
+
+
+void AstCacheWriter::visit(CallExpr& node)
+{
+  kinds.push_back(CALL_NODE);
+  token(node.function_id);
+  refs(node.arg_list);
+  word(node.tail);
+}
+
+
+void AstCacheWriter::visit(IDRValue& node)
+{
+  kinds.push_back(ID_RVALUE_NODE);
+  tokens(node.path);
+  var(node.var);
+  numbers(node.fields);
+}
+
+
+void AstCacheWriter::visit(NegatedRValue& node)
+{
+  kinds.push_back(NEGATED_RVALUE_NODE);
+  ref(node.expr);
+}
+
+
+bool AstCacheWriter::write(const SourceBuffer& source,
+                           const std::string& file_name)
+{
+  AstCacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, AST_CACHE_MAGIC, sizeof(header.magic));
+  header.version = AST_CACHE_VERSION;
+  header.node_count = kinds.size();
+  std::strncpy(header.build, AST_CACHE_BUILD, sizeof(header.build) - 1);
+  header.source_hash = source_hash(source);
+  header.source_size = source.size();
+  header.record_words = records.size();
+  header.string_bytes = strings.size();
+  // the records start on a word boundary
+  while (kinds.size() % sizeof(uint32_t))
+    kinds.push_back(0);
+  std::string payload(reinterpret_cast<const char*>(kinds.data()),
+                      kinds.size());
+  payload.append(reinterpret_cast<const char*>(records.data()),
+                 records.size() * sizeof(uint32_t));
+  payload += strings;
+  header.payload_hash = fnv1a_hash(payload.data(),
+                                   payload.data() + payload.size());
+
+  std::string tmp_name = file_name + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_name, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(payload.data(), payload.size());
+    if (!out.flush()) {
+      std::remove(tmp_name.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    std::remove(tmp_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+//----------------------------------------------------------------------
+// READER
+//----------------------------------------------------------------------
+
+// Rebuilds a program from a mapped cache file: the first pass creates
+// an empty node of each kind in the arena and the second fills in each
+// node's record, looking nodes up by index. Every read is bounds
+// checked, and a damaged file throws std::runtime_error.
+class AstCacheReader
+{
+public:
+
+  AstCacheReader(std::shared_ptr<SourceBuffer> file, Program& program);
+
+  // rebuild the program (the header must already be checked)
+  void read();
+
+private:
+
+  std::shared_ptr<SourceBuffer> file;
+  Program& program;
+  Arena& arena;
+  const AstCacheHeader* header;
+  const uint8_t* kinds;
+  const uint32_t* next;         // the next record word
+  const uint32_t* records_end;
+  const char* strings;
+  std::vector<void*> nodes;     // each node by index (most derived)
+
+  // record helpers
+  uint32_t word();
+  int number() {return static_cast<int>(word());}
+  Token token();
+  Token* optional_token();
+  VarSlot var();
+  BasicIf* basic_if();
+  template<typename T> T* ref();
+  template<typename T> Span<T*> refs();
+  Span<Token> tokens();
+  Span<int> numbers();
+  void corrupt() {throw std::runtime_error("damaged ast cache file");}
+
+  // create the node of each kind and fill in its record
+  void* make(AstNodeKind kind);
+  void fill(AstNodeKind kind, void* node);
+};
+
+
+// convert the most derived node D to its base T (or null if it is not
+// a T)
+template<typename T, typename D,
+         bool IsBase = std::is_base_of<T, D>::value>
+struct AstCacheCast
+{
+  static T* from(void* node) {return static_cast<D*>(node);}
+};
+
+template<typename T, typename D>
+struct AstCacheCast<T, D, false>
+{
+  static T* from(void*) {return nullptr;}
+};
+
+
+AstCacheReader::AstCacheReader(std::shared_ptr<SourceBuffer> file,
+                               Program& program)
+  : file(file), program(program), arena(program.arena)
+{
+  header = reinterpret_cast<const AstCacheHeader*>(file->begin());
+  kinds = reinterpret_cast<const uint8_t*>(file->begin() + sizeof(*header));
+  size_t kinds_size = (header->node_count + 3) / 4 * 4;
+  next = reinterpret_cast<const uint32_t*>(kinds + kinds_size);
+  records_end = next + header->record_words;
+  strings = reinterpret_cast<const char*>(records_end);
+}
+
+
+uint32_t AstCacheReader::word()
+{
+  if (next == records_end)
+    corrupt();
+  return *next++;
+}
+
+
+Token AstCacheReader::token()
+{
+  uint32_t type = word();
+  uint32_t offset = word();
+  uint32_t length = word();
+  int line = number();
+  int column = number();
+  if (type > EOS or offset > header->string_bytes or
+      length > header->string_bytes - offset)
+    corrupt();
+  return Token(static_cast<TokenType>(type), strings + offset, length, line,
+               column);
+}
+
+
+Token* AstCacheReader::optional_token()
+{
+  if (!word())
+    return nullptr;
+  return arena.make<Token>(token());
+}
+
+
+VarSlot AstCacheReader::var()
+{
+  VarSlot v;
+  v.depth = number();
+  v.slot = number();
+  return v;
+}
+
+
+BasicIf* AstCacheReader::basic_if()
+{
+  BasicIf* b = arena.make<BasicIf>();
+  b->expr = ref<Expr>();
+  b->stmts = refs<Stmt>();
+  return b;
+}
+
+
+// the node with the next index as a T (null for a missing node)
+template<typename T>
+T* AstCacheReader::ref()
+{
+  uint32_t index = word();
+  if (index == NO_NODE)
+    return nullptr;
+  if (index >= nodes.size())
+    corrupt();
+  void* node = nodes[index];
+  T* result = nullptr;
+  switch (kinds[index]) {
+    case FUN_DECL_NODE: result = AstCacheCast<T, FunDecl>::from(node); break;
+    case TYPE_DECL_NODE: result = AstCacheCast<T, TypeDecl>::from(node); break;
+    case VAR_DECL_NODE: result = AstCacheCast<T, VarDeclStmt>::from(node); break;
+    case ASSIGN_NODE: result = AstCacheCast<T, AssignStmt>::from(node); break;
+    case RETURN_NODE: result = AstCacheCast<T, ReturnStmt>::from(node); break;
+    case IF_NODE: result = AstCacheCast<T, IfStmt>::from(node); break;
+    case WHILE_NODE: result = AstCacheCast<T, WhileStmt>::from(node); break;
+    case FOR_NODE: result = AstCacheCast<T, ForStmt>::from(node); break;
+    case EXPR_NODE: result = AstCacheCast<T, Expr>::from(node); break;
+    case SIMPLE_TERM_NODE: result = AstCacheCast<T, SimpleTerm>::from(node); break;
+    case COMPLEX_TERM_NODE: result = AstCacheCast<T, ComplexTerm>::from(node); break;
+    case SIMPLE_RVALUE_NODE: result = AstCacheCast<T, SimpleRValue>::from(node); break;
+    case NEW_RVALUE_NODE: result = AstCacheCast<T, NewRValue>::from(node); break;
+    case CALL_NODE: result = AstCacheCast<T, CallExpr>::from(node); break;
+    case ID_RVALUE_NODE: result = AstCacheCast<T, IDRValue>::from(node); break;
+    case NEGATED_RVALUE_NODE: result = AstCacheCast<T, NegatedRValue>::from(node); break;
+  }
+  if (!result)
+    corrupt();
+  return result;
+}
+
+
+template<typename T>
+Span<T*> AstCacheReader::refs()
+{
+  uint32_t count = word();
+  if (count > static_cast<size_t>(records_end - next))
+    corrupt();
+  Span<T*> list = arena.fill(count, static_cast<T*>(nullptr));
+  for (T*& node : list)
+    node = ref<T>();
+  return list;
+}
+
+
+Span<Token> AstCacheReader::tokens()
+{
+  uint32_t count = word();
+  if (count > static_cast<size_t>(records_end - next))
+    corrupt();
+  Span<Token> list = arena.fill(count, Token());
+  for (Token& t : list)
+    t = token();
+  return list;
+}
+
+
+Span<int> AstCacheReader::numbers()
+{
+  uint32_t count = word();
+  if (count > static_cast<size_t>(records_end - next))
+    corrupt();
+  Span<int> list = arena.fill(count, 0);
+  for (int& n : list)
+    n = number();
+  return list;
+}
+
+
+void* AstCacheReader::make(AstNodeKind kind)
+{
+  switch (kind) {
+    case FUN_DECL_NODE: return arena.make<FunDecl>();
+    case TYPE_DECL_NODE: return arena.make<TypeDecl>();
+    case VAR_DECL_NODE: return arena.make<VarDeclStmt>();
+    case ASSIGN_NODE: return arena.make<AssignStmt>();
+    case RETURN_NODE: return arena.make<ReturnStmt>();
+    case IF_NODE: return arena.make<IfStmt>();
+    case WHILE_NODE: return arena.make<WhileStmt>();
+    case FOR_NODE: return arena.make<ForStmt>();
+    case EXPR_NODE: return arena.make<Expr>();
+    case SIMPLE_TERM_NODE: return arena.make<SimpleTerm>();
+    case COMPLEX_TERM_NODE: return arena.make<ComplexTerm>();
+    case SIMPLE_RVALUE_NODE: return arena.make<SimpleRValue>();
+    case NEW_RVALUE_NODE: return arena.make<NewRValue>();
+    case CALL_NODE: return arena.make<CallExpr>();
+    case ID_RVALUE_NODE: return arena.make<IDRValue>();
+    case NEGATED_RVALUE_NODE: return arena.make<NegatedRValue>();
+    default: corrupt();
+  }
+  return nullptr;
+}
+
+
+void AstCacheReader::fill(AstNodeKind kind, void* node)
+{
+  switch (kind) {
+    case FUN_DECL_NODE: {
+      FunDecl& n = *static_cast<FunDecl*>(node);
+      n.return_type = token();
+      n.id = token();
+      uint32_t count = word();
+      if (count > static_cast<size_t>(records_end - next))
+        corrupt();
+      n.params = arena.fill(count, FunDecl::FunParam());
+      for (FunDecl::FunParam& param : n.params) {
+        param.id = token();
+        param.type = token();
+      }
+      n.stmts = refs<Stmt>();
+      break;
+    }
+    case TYPE_DECL_NODE: {
+      TypeDecl& n = *static_cast<TypeDecl*>(node);
+      n.id = token();
+      n.vdecls = refs<VarDeclStmt>();
+      break;
+    }
+    case VAR_DECL_NODE: {
+      VarDeclStmt& n = *static_cast<VarDeclStmt*>(node);
+      n.type = optional_token();
+      n.id = token();
+      n.expr = ref<Expr>();
+      n.var = var();
+      break;
+    }
+    case ASSIGN_NODE: {
+      AssignStmt& n = *static_cast<AssignStmt*>(node);
+      n.lvalue_list = tokens();
+      n.expr = ref<Expr>();
+      n.var = var();
+      n.fields = numbers();
+      break;
+    }
+    case RETURN_NODE:
+      static_cast<ReturnStmt*>(node)->expr = ref<Expr>();
+      break;
+    case IF_NODE: {
+      IfStmt& n = *static_cast<IfStmt*>(node);
+      n.if_part = basic_if();
+      uint32_t count = word();
+      if (count > static_cast<size_t>(records_end - next))
+        corrupt();
+      n.else_ifs = arena.fill(count, static_cast<BasicIf*>(nullptr));
+      for (BasicIf*& else_if : n.else_ifs)
+        else_if = basic_if();
+      n.body_stmts = refs<Stmt>();
+      break;
+    }
+    case WHILE_NODE: {
+      WhileStmt& n = *static_cast<WhileStmt*>(node);
+      n.expr = ref<Expr>();
+      n.stmts = refs<Stmt>();
+      break;
+    }
+    case FOR_NODE: {
+      ForStmt& n = *static_cast<ForStmt*>(node);
+      n.var_id = token();
+      n.var = var();
+      n.start = ref<Expr>();
+      n.end = ref<Expr>();
+      n.stmts = refs<Stmt>();
+      break;
+    }
+    case EXPR_NODE: {
+      Expr& n = *static_cast<Expr*>(node);
+      n.negated = word() != 0;
+      n.first = ref<ExprTerm>();
+      n.op = optional_token();
+      n.rest = ref<Expr>();
+      break;
+    }
+    case SIMPLE_TERM_NODE:
+      static_cast<SimpleTerm*>(node)->rvalue = ref<RValue>();
+      break;
+    case COMPLEX_TERM_NODE:
+      static_cast<ComplexTerm*>(node)->expr = ref<Expr>();
+      break;
+    case SIMPLE_RVALUE_NODE:
+      static_cast<SimpleRValue*>(node)->value = token();
+      break;
+    case NEW_RVALUE_NODE:
+      static_cast<NewRValue*>(node)->type_id = token();
+      break;
+    case CALL_NODE: {
+      CallExpr& n = *static_cast<CallExpr*>(node);
+      n.function_id = token();
+      n.arg_list = refs<Expr>();
+      n.tail = word() != 0;
+      break;
+    }
+    case ID_RVALUE_NODE: {
+      IDRValue& n = *static_cast<IDRValue*>(node);
+      n.path = tokens();
+      n.var = var();
+      n.fields = numbers();
+      break;
+    }
+    case NEGATED_RVALUE_NODE:
+      static_cast<NegatedRValue*>(node)->expr = ref<Expr>();
+      break;
+    default:
+      corrupt();
+  }
+}
+
+
+void AstCacheReader::read()
+{
+  nodes.reserve(header->node_count);
+  for (uint32_t i = 0; i < header->node_count; ++i)
+    nodes.push_back(make(static_cast<AstNodeKind>(kinds[i])));
+  Span<Decl*> decls = refs<Decl>();
+  for (uint32_t i = 0; i < header->node_count; ++i)
+    fill(static_cast<AstNodeKind>(kinds[i]), nodes[i]);
+  if (next != records_end)
+    corrupt();
+  // tokens point into the mapped file from now on
+  program.decls = decls;
+  program.source = file;
+}
+
+
+//----------------------------------------------------------------------
+// CACHE ENTRIES
+//----------------------------------------------------------------------
+
+__attribute__((SCAN_OPTIMIZE))
+uint64_t fnv1a_hash(const char* begin, const char* end)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char* p = begin; p != end; ++p) {
+    hash ^= static_cast<unsigned char>(*p);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+
+uint64_t source_hash(const SourceBuffer& source)
+{
+  return fnv1a_hash(source.begin(), source.end());
+}
+
+
+// create the directory and any missing parents
+bool make_directories(const std::string& path)
+{
+  for (size_t i = 1; i <= path.size(); ++i) {
+    if (i == path.size() or path[i] == '/') {
+      std::string dir = path.substr(0, i);
+      if (mkdir(dir.c_str(), 0755) != 0 and errno != EEXIST)
+        return false;
+    }
+  }
+  return true;
+}
+
+
+std::string ast_cache_path(const SourceBuffer& source)
+{
+  std::string dir;
+  if (const char* cache_dir = std::getenv("MYPL_CACHE_DIR"))
+    dir = cache_dir;
+  else if (const char* xdg_dir = std::getenv("XDG_CACHE_HOME"))
+    dir = std::string(xdg_dir) + "/mypl";
+  else if (const char* home_dir = std::getenv("HOME"))
+    dir = std::string(home_dir) + "/.cache/mypl";
+  if (dir.empty() or !make_directories(dir))
+    return "";
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%016llx.ast",
+                static_cast<unsigned long long>(source_hash(source)));
+  return dir + name;
+}
+
+
+bool load_ast_cache(const std::string& cache_file,
+                    const SourceBuffer& source, Program& program)
+{
+  std::shared_ptr<SourceBuffer> file =
+    std::make_shared<SourceBuffer>(cache_file);
+  const AstCacheHeader* header =
+    reinterpret_cast<const AstCacheHeader*>(file->begin());
+  if (file->size() < sizeof(*header) or
+      std::memcmp(header->magic, AST_CACHE_MAGIC, sizeof(header->magic)) or
+      header->version != AST_CACHE_VERSION or
+      std::strncmp(header->build, AST_CACHE_BUILD, sizeof(header->build)) or
+      header->source_size != source.size() or
+      header->source_hash != source_hash(source))
+    return false;
+  // the sections must exactly fill the file
+  uint64_t kinds_size = (static_cast<uint64_t>(header->node_count) + 3) / 4 * 4;
+  if (header->record_words > file->size() or header->string_bytes > file->size() or
+      sizeof(*header) + kinds_size + header->record_words * sizeof(uint32_t) +
+      header->string_bytes != file->size() or
+      header->payload_hash != fnv1a_hash(file->begin() + sizeof(*header),
+                                         file->end()))
+    return false;
+  try {
+    AstCacheReader reader(file, program);
+    reader.read();
+  } catch (const std::runtime_error& e) {
+    return false;
+  }
+  return true;
+}
+
+
+bool save_ast_cache(Program& program, const SourceBuffer& source,
+                    const std::string& cache_file)
+{
+  AstCacheWriter writer;
+  program.accept(writer);
+  return writer.write(source, cache_file);
+}
+
+
+#endif
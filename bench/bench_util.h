@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: bench_util.h
+// DATE: Oct 16, 2026
+// DESC: Helpers shared by the benchmarks: finding the MyPL programs to
+//       run and (in a benchmark that defines BENCH_COUNT_ALLOCS before
+//       including this file) counting every heap allocation by
+//       replacing the global operator new and delete.
+//----------------------------------------------------------------------
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <dirent.h>
+
+#ifndef MYPL_SOURCE_DIR
+#define MYPL_SOURCE_DIR "."
+#endif
+
+
+// the .mypl files in the given directory (sorted)
+std::vector<std::string> mypl_files(const std::string& dir_name)
+{
+  std::vector<std::string> file_names;
+  DIR* dir = opendir(dir_name.c_str());
+  if (!dir)
+    return file_names;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > 5 and name.substr(name.size() - 5) == ".mypl")
+      file_names.push_back(dir_name + "/" + name);
+  }
+  closedir(dir);
+  std::sort(file_names.begin(), file_names.end());
+  return file_names;
+}
+
+
+// the programs benchmarked by default: every .mypl file in tests/ and
+// bench/ of the source tree
+std::vector<std::string> default_mypl_files()
+{
+  std::vector<std::string> file_names;
+  for (const auto& dir : {"/tests", "/tests/my_tests", "/bench"})
+    for (const std::string& f : mypl_files(std::string(MYPL_SOURCE_DIR) + dir))
+      file_names.push_back(f);
+  return file_names;
+}
+
+
+#ifdef BENCH_COUNT_ALLOCS
+
+// global allocation counters (every operator new)
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+// gcc inlines these into library code that it sees pair ::operator new
+// with free, and warns although both sides are replaced here
+#if defined(__GNUC__) and !defined(__clang__) and __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+  ++alloc_count;
+  alloc_bytes += size;
+  void* p = std::malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+#if defined(__GNUC__) and !defined(__clang__) and __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+
+#endif
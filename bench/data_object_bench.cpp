@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: data_object_bench.cpp
+// DATE: Oct 16, 2026
+// DESC: Microbenchmark for DataObject. Repeatedly evaluates literal
+//       expressions through Interpreter::visit(Expr&) and reports the
+//       number of heap allocations and the time per evaluation.
+//----------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include "token.h"
+#include "mypl_exception.h"
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "type_checker.h"
+#include "interpreter.h"
+#define BENCH_COUNT_ALLOCS
+#include "bench_util.h"
+
+using namespace std;
+
+
+// each var initializer in main is benchmarked as one expression
+const char* BENCH_PROGRAM =
+  "fun int main()\n"
+  "  var int_expr = 1 + 2 * 3 - 4 % 5 + 6 / 2\n"
+  "  var double_expr = 1.5 * 2.0 + 0.25 - 3.0 / 4.0\n"
+  "  var bool_expr = (3 < 4) and ((2 >= 1) or (5 != 5))\n"
+  "  var char_expr = 'a' < 'b'\n"
+  "  var string_expr = \"ab\" + \"cd\"\n"
+  "end\n";
+
+
+int main(int argc, char* argv[])
+{
+  int iterations = 1000000;
+  if (argc == 2)
+    iterations = atoi(argv[1]);
+
+  istringstream input(BENCH_PROGRAM);
+  Lexer lexer(input);
+  Parser parser(lexer);
+  Program program;
+  try {
+    parser.parse(program);
+    TypeChecker type_checker;
+    program.accept(type_checker);
+  } catch (const MyPLException& e) {
+    cout << e.to_string() << endl;
+    return 1;
+  }
+
+  Interpreter interpreter;
+  FunDecl* main_decl = (FunDecl*)program.decls.front();
+  cout << "expression          allocs/eval   ns/eval" << endl;
+  for (Stmt* s : main_decl->stmts) {
+    VarDeclStmt* vdecl = (VarDeclStmt*)s;
+    Expr* expr = vdecl->expr;
+    expr->accept(interpreter);  // warm up
+    size_t start_allocs = alloc_count;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+      expr->accept(interpreter);
+    auto end = chrono::steady_clock::now();
+    double allocs = double(alloc_count - start_allocs) / iterations;
+    double ns = chrono::duration<double, nano>(end - start).count() / iterations;
+    string name = vdecl->id.lexeme();
+    cout << name << string(20 - name.size(), ' ') << allocs
+         << "\t\t" << ns << endl;
+  }
+}
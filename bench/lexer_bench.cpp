@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: lexer_bench.cpp
+// DATE: Oct 16, 2026
+// DESC: Lexer throughput benchmark. Builds one large source out of
+//       MyPL programs (by default every .mypl file in tests/ and
+//       bench/, repeated up to the target size), lexes it with each
+//       byte scanner the cpu supports, and reports the best throughput
+//       in MB/s. The token streams of all scanners must be identical.
+//
+//       usage: lexer_bench [-mb size] [-n runs] [file ...]
+//----------------------------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "token.h"
+#include "mypl_exception.h"
+#include "lexer.h"
+#include "bench_util.h"
+
+using namespace std;
+
+
+// lex the whole source, returning a checksum of the token stream
+// (types, positions, and lexemes) and setting the token count
+size_t lex_all(shared_ptr<SourceBuffer> source, size_t& tokens)
+{
+  Lexer lexer(source);
+  size_t sum = 0;
+  tokens = 0;
+  Token t;
+  do {
+    t = lexer.next_token();
+    sum = sum * 31 + t.type() * 7 + t.line() * 3 + t.column() +
+      t.lexeme().size();
+    ++tokens;
+  } while (t.type() != EOS);
+  return sum;
+}
+
+
+int main(int argc, char* argv[])
+{
+  double target_mb = 16;
+  int runs = 5;
+  vector<string> file_names;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-mb" and i + 1 < argc)
+      target_mb = atof(argv[++i]);
+    else if (arg == "-n" and i + 1 < argc)
+      runs = max(1, atoi(argv[++i]));
+    else
+      file_names.push_back(arg);
+  }
+  if (file_names.empty())
+    file_names = default_mypl_files();
+
+  // each copy of a program ends with a newline so tokens never merge
+  // across files
+  string corpus;
+  for (const string& file_name : file_names) {
+    ifstream file(file_name);
+    stringstream text;
+    text << file.rdbuf();
+    corpus += text.str() + "\n";
+  }
+  if (corpus.empty()) {
+    cerr << "no source to lex" << endl;
+    return 1;
+  }
+  string unit = corpus;
+  while (corpus.size() < target_mb * 1024 * 1024)
+    corpus += unit;
+  istringstream input(corpus);
+  shared_ptr<SourceBuffer> source = make_shared<SourceBuffer>(input);
+  double mb = source->size() / (1024.0 * 1024.0);
+
+  cout << "lexing " << mb << " MB, best of " << runs << endl;
+  cout << "scanner   MB/s        tokens" << endl;
+  size_t expected_sum = 0;
+  int status = 0;
+  vector<string> names = byte_scanner_names();
+  for (size_t n = 0; n < names.size(); ++n) {
+    select_byte_scanner(names[n]);
+    double best_ms = 0;
+    size_t tokens = 0, sum = 0;
+    try {
+      for (int i = 0; i < runs; ++i) {
+        auto start = chrono::steady_clock::now();
+        sum = lex_all(source, tokens);
+        auto end = chrono::steady_clock::now();
+        double ms = chrono::duration<double, milli>(end - start).count();
+        if (i == 0 or ms < best_ms)
+          best_ms = ms;
+      }
+    } catch (const MyPLException& e) {
+      cout << e.to_string() << endl;
+      return 1;
+    }
+    cout << names[n] << string(10 - names[n].size(), ' ')
+         << mb / (best_ms / 1000) << "\t" << tokens << endl;
+    if (n == 0)
+      expected_sum = sum;
+    else if (sum != expected_sum) {
+      cout << "  token stream differs from " << names[0] << endl;
+      status = 1;
+    }
+  }
+  return status;
+}
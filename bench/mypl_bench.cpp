@@ -0,0 +1,315 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: mypl_bench.cpp
+// DATE: Oct 16, 2026
+// DESC: Benchmark harness for whole MyPL programs. Runs each program
+//       (by default every .mypl file in tests/ and bench/) a number of
+//       times in-process with the debugger prompt bypassed, and
+//       reports the wall time of each phase, the heap allocations per
+//       run, and the peak resident set size as JSON.
+//
+//       Phases: lex is a separate pass over the whole source, parse
+//       includes the lexing the parser does on demand, check is type
+//       checking, inlining, variable resolution, and optimization,
+//       load replaces all four with reading the checked program from
+//       the ast cache (-cache only), compile is bytecode generation
+//       (vm only), and run executes main.
+//
+//       usage: mypl_bench [-ast | -vm] [-cache] [-n runs]
+//                         [-o file.json] [file ...]
+//----------------------------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sys/resource.h>
+#include "token.h"
+#include "mypl_exception.h"
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "front_end.h"
+#include "interpreter.h"
+#include "compiler.h"
+#include "vm.h"
+#include "ast_cache.h"
+#define BENCH_COUNT_ALLOCS
+#include "bench_util.h"
+
+using namespace std;
+
+
+// the benchmark phases, in order
+enum Phase {LEX, PARSE, CHECK, LOAD, COMPILE, RUN, PHASE_COUNT};
+const char* PHASE_NAMES[] = {"lex", "parse", "check", "load", "compile",
+                             "run"};
+
+// standard input given to programs that call read()
+const char* BENCH_INPUT = "hello\nhello\nhello\nhello\nhello\nhello\n";
+
+
+// the measurements of one program over all runs
+struct Result
+{
+  string file_name;
+  string error;                 // first error message (if any)
+  int runs = 0;                 // completed runs
+  double phase_ms[PHASE_COUNT] = {0};  // summed over the runs
+  double min_total_ms = 0;
+  size_t allocs = 0;            // summed over the runs
+  size_t bytes = 0;
+  long peak_rss_kb = 0;         // process high-water mark afterwards
+};
+
+
+// discards everything written to it
+class NullBuffer : public streambuf
+{
+protected:
+  int overflow(int c) {return c;}
+  streamsize xsputn(const char*, streamsize n) {return n;}
+};
+
+
+// time one phase, adding the elapsed milliseconds to total
+class PhaseTimer
+{
+public:
+  PhaseTimer(double& total) : total(total),
+    start(chrono::steady_clock::now()) {}
+  ~PhaseTimer() {
+    auto end = chrono::steady_clock::now();
+    total += chrono::duration<double, milli>(end - start).count();
+  }
+private:
+  double& total;
+  chrono::steady_clock::time_point start;
+};
+
+
+// run the program once, adding the phase times to times (the front
+// end is replaced by loading the given cache file if there is one)
+void run_once(shared_ptr<SourceBuffer> source, const string& cache_file,
+              bool use_vm, double times[])
+{
+  Program program;
+  if (!cache_file.empty()) {
+    PhaseTimer timer(times[LOAD]);
+    if (!load_ast_cache(cache_file, *source, program))
+      throw runtime_error("unable to load " + cache_file);
+  }
+  else {
+    {
+      PhaseTimer timer(times[LEX]);
+      Lexer lexer(source);
+      while (lexer.next_token().type() != EOS)
+        ;
+    }
+    {
+      PhaseTimer timer(times[PARSE]);
+      Lexer lexer(source);
+      Parser parser(lexer);
+      parser.parse(program);
+    }
+    {
+      PhaseTimer timer(times[CHECK]);
+      check_program(program);
+    }
+  }
+  if (!use_vm) {
+    PhaseTimer timer(times[RUN]);
+    Interpreter interpreter(false);
+    program.accept(interpreter);
+    return;
+  }
+  Module module;
+  {
+    PhaseTimer timer(times[COMPILE]);
+    Compiler compiler(module);
+    program.accept(compiler);
+  }
+  PhaseTimer timer(times[RUN]);
+  VM vm(module);
+  vm.run();
+}
+
+
+// write the checked program to the ast cache, returning the file
+string cache_program(shared_ptr<SourceBuffer> source)
+{
+  Program program;
+  Lexer lexer(source);
+  Parser parser(lexer);
+  parser.parse(program);
+  check_program(program);
+  string cache_file = ast_cache_path(*source);
+  if (cache_file.empty() or !save_ast_cache(program, *source, cache_file))
+    throw runtime_error("unable to write the ast cache");
+  return cache_file;
+}
+
+
+// run the program the given number of times, silencing its output
+Result bench(const string& file_name, bool use_vm, bool use_cache, int runs)
+{
+  Result result;
+  result.file_name = file_name;
+  if (!ifstream(file_name)) {
+    result.error = "unable to open file";
+    return result;
+  }
+  // every run lexes the same mapped file
+  shared_ptr<SourceBuffer> source = make_shared<SourceBuffer>(file_name);
+  string cache_file;
+  if (use_cache) {
+    try {
+      cache_file = cache_program(source);
+    } catch (const MyPLException& e) {
+      result.error = e.to_string();
+    } catch (exception& e) {
+      result.error = string("Error: ") + e.what();
+    }
+    if (!result.error.empty())
+      return result;
+  }
+
+  NullBuffer null_buffer;
+  streambuf* cout_buf = cout.rdbuf(&null_buffer);
+  for (int i = 0; i < runs; ++i) {
+    istringstream input(BENCH_INPUT);
+    streambuf* cin_buf = cin.rdbuf(input.rdbuf());
+    double times[PHASE_COUNT] = {0};
+    size_t start_allocs = alloc_count;
+    size_t start_bytes = alloc_bytes;
+    try {
+      run_once(source, cache_file, use_vm, times);
+    } catch (const MyPLException& e) {
+      result.error = e.to_string();
+    } catch (exception& e) {
+      result.error = string("Error: ") + e.what();
+    }
+    cin.rdbuf(cin_buf);
+    if (!result.error.empty())
+      break;
+    result.allocs += alloc_count - start_allocs;
+    result.bytes += alloc_bytes - start_bytes;
+    double total = 0;
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      result.phase_ms[p] += times[p];
+      total += times[p];
+    }
+    if (result.runs == 0 or total < result.min_total_ms)
+      result.min_total_ms = total;
+    ++result.runs;
+  }
+  cout.rdbuf(cout_buf);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result.peak_rss_kb = usage.ru_maxrss;
+  return result;
+}
+
+
+// escape a string for a json string value
+string json_string(const string& s)
+{
+  string out = "\"";
+  for (char c : s) {
+    if (c == '"' or c == '\\')
+      out += string("\\") + c;
+    else if (c == '\n')
+      out += "\\n";
+    else if (c == '\t')
+      out += "\\t";
+    else if ((unsigned char)c < 0x20)
+      out += " ";
+    else
+      out += c;
+  }
+  return out + "\"";
+}
+
+
+void write_json(ostream& out, const vector<Result>& results, bool use_vm,
+                int runs)
+{
+  out << "{\n";
+  out << "  \"mode\": \"" << (use_vm ? "vm" : "ast") << "\",\n";
+  out << "  \"runs\": " << runs << ",\n";
+  out << "  \"programs\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    double n = r.runs ? r.runs : 1;
+    double total = 0;
+    out << (i ? ",\n" : "\n") << "    {\n";
+    out << "      \"file\": " << json_string(r.file_name) << ",\n";
+    out << "      \"ok\": " << (r.error.empty() ? "true" : "false") << ",\n";
+    if (!r.error.empty())
+      out << "      \"error\": " << json_string(r.error) << ",\n";
+    out << "      \"runs\": " << r.runs << ",\n";
+    out << "      \"phase_ms\": {";
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      out << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": "
+          << r.phase_ms[p] / n;
+      total += r.phase_ms[p] / n;
+    }
+    out << "},\n";
+    out << "      \"total_ms\": " << total << ",\n";
+    out << "      \"min_total_ms\": " << r.min_total_ms << ",\n";
+    out << "      \"allocations\": " << (size_t)(r.allocs / n) << ",\n";
+    out << "      \"allocated_bytes\": " << (size_t)(r.bytes / n) << ",\n";
+    out << "      \"peak_rss_kb\": " << r.peak_rss_kb << "\n";
+    out << "    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+  bool use_vm = true;
+  bool use_cache = false;
+  int runs = 5;
+  string json_file;
+  vector<string> file_names;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-ast" or arg == "-vm")
+      use_vm = arg == "-vm";
+    else if (arg == "-cache")
+      use_cache = true;
+    else if (arg == "-n" and i + 1 < argc)
+      runs = max(1, atoi(argv[++i]));
+    else if (arg == "-o" and i + 1 < argc)
+      json_file = argv[++i];
+    else
+      file_names.push_back(arg);
+  }
+  if (file_names.empty())
+    file_names = default_mypl_files();
+
+  vector<Result> results;
+  for (const string& file_name : file_names) {
+    results.push_back(bench(file_name, use_vm, use_cache, runs));
+    const Result& r = results.back();
+    // progress and a summary line on stderr
+    cerr << file_name << ": ";
+    if (r.error.empty())
+      cerr << r.min_total_ms << " ms (min of " << r.runs << ")" << endl;
+    else
+      cerr << r.error << endl;
+  }
+
+  if (json_file.empty())
+    write_json(cout, results, use_vm, runs);
+  else {
+    ofstream out(json_file);
+    write_json(out, results, use_vm, runs);
+  }
+}
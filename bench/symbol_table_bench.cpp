@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: symbol_table_bench.cpp
+// DATE: Oct 16, 2026
+// DESC: Microbenchmark for SymbolTable. At each environment depth,
+//       repeatedly pushes an environment, declares a few variables in
+//       it, looks up names declared at every level (as the type
+//       checker does for each variable use), assigns values to its
+//       variables, and pops it again. It reports the time per push/pop
+//       pair, per lookup, and per value assignment.
+//
+//       usage: symbol_table_bench [iterations]
+//----------------------------------------------------------------------
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "symbol_table.h"
+
+using namespace std;
+
+
+// variables declared in each environment
+const int NAMES_PER_ENV = 4;
+
+
+// the name of a variable declared at the given depth
+string var_name(int depth, int i)
+{
+  return "var_" + to_string(depth) + "_" + to_string(i);
+}
+
+
+int main(int argc, char* argv[])
+{
+  int iterations = 100000;
+  if (argc == 2)
+    iterations = atoi(argv[1]);
+
+  cout << "depth   ns/push+pop   ns/lookup   ns/assign" << endl;
+  for (int depth : {2, 4, 8, 16, 32}) {
+    // the enclosing environments (global, function, nested blocks)
+    SymbolTable table;
+    for (int d = 0; d < depth - 1; ++d) {
+      table.push_environment();
+      for (int i = 0; i < NAMES_PER_ENV; ++i) {
+        table.add_name(var_name(d, i));
+        table.set_str_info(var_name(d, i), "int");
+      }
+    }
+    vector<string> inner_names, lookups;
+    for (int i = 0; i < NAMES_PER_ENV; ++i)
+      inner_names.push_back(var_name(depth - 1, i));
+    for (int d = 0; d < depth; ++d)
+      lookups.push_back(var_name(d, d % NAMES_PER_ENV));
+
+    // push/pop of the innermost environment with its declarations
+    string type;
+    auto start = chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+      table.push_environment();
+      for (const string& name : inner_names) {
+        table.add_name(name);
+        table.set_str_info(name, "int");
+      }
+      table.pop_environment();
+    }
+    auto mid = chrono::steady_clock::now();
+
+    // lookups from the innermost environment
+    table.push_environment();
+    for (const string& name : inner_names) {
+      table.add_name(name);
+      table.set_str_info(name, "int");
+    }
+    size_t found = 0;
+    auto lookup_start = chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+      for (const string& name : lookups) {
+        if (table.name_exists(name)) {
+          table.get_str_info(name, type);
+          found += type.size();
+        }
+      }
+    }
+    auto end = chrono::steady_clock::now();
+
+    // value assignments to the innermost variables (updated in place)
+    DataObject val;
+    auto assign_start = chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+      val.set(n);
+      for (const string& name : inner_names)
+        table.set_val_info(name, val);
+    }
+    auto assign_end = chrono::steady_clock::now();
+    table.get_val_info(inner_names[0], val);
+    table.pop_environment();
+
+    int last = -1;
+    val.value(last);
+    if (found != (size_t)iterations * lookups.size() * 3
+        or last != iterations - 1) {
+      cout << "lookup or assignment failed at depth " << depth << endl;
+      return 1;
+    }
+    double push_pop = chrono::duration<double, nano>(mid - start).count()
+      / iterations;
+    double lookup = chrono::duration<double, nano>(end - lookup_start).count()
+      / ((double)iterations * lookups.size());
+    double assign = chrono::duration<double, nano>(assign_end - assign_start)
+      .count() / ((double)iterations * inner_names.size());
+    cout << depth << string(8 - to_string(depth).size(), ' ') << push_pop
+         << "\t\t" << lookup << "\t\t" << assign << endl;
+  }
+}
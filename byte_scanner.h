@@ -0,0 +1,265 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: byte_scanner.h
+// DATE: Oct 16, 2026
+// DESC: Vectorized scanning of the byte runs the lexer skips over:
+//       blanks between tokens, the rest of a # comment, and the body
+//       of a string literal. Each scan has a scalar version plus SSE2
+//       and AVX2 versions on x86, and the best one the cpu supports is
+//       picked at runtime (the first time a scanner is needed).
+//----------------------------------------------------------------------
+
+#ifndef BYTE_SCANNER_H
+#define BYTE_SCANNER_H
+
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MYPL_X86_SCAN
+#include <immintrin.h>
+#endif
+
+// the scan loops are compiled with optimization even in -O0 builds (an
+// unoptimized intrinsic loop spills every vector to memory and is
+// slower than a byte loop)
+#if defined(__GNUC__) && !defined(__clang__)
+#define SCAN_OPTIMIZE optimize("O2"),
+#else
+#define SCAN_OPTIMIZE
+#endif
+
+
+// one implementation of the scans (both stop at end if nothing is found)
+struct ByteScanner
+{
+  // the name of the implementation ("scalar", "sse2", or "avx2")
+  const char* name;
+
+  // the first byte from p on that is not a blank (a space, tab,
+  // carriage return, vertical tab, or form feed; newlines are not
+  // blanks since the lexer counts lines)
+  const char* (*skip_blanks)(const char* p, const char* end);
+
+  // the first byte from p on that is a, b, or c
+  const char* (*find_any)(const char* p, const char* end, char a, char b,
+                          char c);
+};
+
+
+//----------------------------------------------------------------------
+// The scanner used by the lexer (the fastest supported one unless
+// another was selected).
+//----------------------------------------------------------------------
+const ByteScanner& byte_scanner();
+
+//----------------------------------------------------------------------
+// Use the named scanner from now on.
+// Inputs:
+//   name -- "scalar", "sse2", or "avx2"
+// Returns:
+//   false (and keeps the current scanner) if the scanner is not
+//   supported on this cpu
+//----------------------------------------------------------------------
+bool select_byte_scanner(const std::string& name);
+
+//----------------------------------------------------------------------
+// The names of the scanners supported on this cpu (slowest first).
+//----------------------------------------------------------------------
+std::vector<std::string> byte_scanner_names();
+
+
+//----------------------------------------------------------------------
+// SCALAR
+//----------------------------------------------------------------------
+
+bool is_blank_byte(char c)
+{
+  return c == ' ' or c == '\t' or c == '\r' or c == '\v' or c == '\f';
+}
+
+
+__attribute__((SCAN_OPTIMIZE))
+const char* skip_blanks_scalar(const char* p, const char* end)
+{
+  while (p < end and is_blank_byte(*p))
+    ++p;
+  return p;
+}
+
+
+__attribute__((SCAN_OPTIMIZE))
+const char* find_any_scalar(const char* p, const char* end, char a, char b,
+                            char c)
+{
+  while (p < end and *p != a and *p != b and *p != c)
+    ++p;
+  return p;
+}
+
+
+#ifdef MYPL_X86_SCAN
+
+//----------------------------------------------------------------------
+// SSE2 (16 bytes at a time)
+//----------------------------------------------------------------------
+
+__attribute__((SCAN_OPTIMIZE target("sse2")))
+const char* skip_blanks_sse2(const char* p, const char* end)
+{
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i vt = _mm_set1_epi8('\v');
+  const __m128i ff = _mm_set1_epi8('\f');
+  for (; end - p >= 16; p += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i blank = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, cr),
+                                _mm_cmpeq_epi8(bytes, vt)),
+                   _mm_cmpeq_epi8(bytes, ff)));
+    unsigned mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return skip_blanks_scalar(p, end);
+}
+
+
+__attribute__((SCAN_OPTIMIZE target("sse2")))
+const char* find_any_sse2(const char* p, const char* end, char a, char b,
+                          char c)
+{
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c);
+  for (; end - p >= 16; p += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i found = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(bytes, va), _mm_cmpeq_epi8(bytes, vb)),
+      _mm_cmpeq_epi8(bytes, vc));
+    unsigned mask = _mm_movemask_epi8(found);
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return find_any_scalar(p, end, a, b, c);
+}
+
+
+//----------------------------------------------------------------------
+// AVX2 (32 bytes at a time)
+//----------------------------------------------------------------------
+
+__attribute__((SCAN_OPTIMIZE target("avx2")))
+const char* skip_blanks_avx2(const char* p, const char* end)
+{
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i vt = _mm256_set1_epi8('\v');
+  const __m256i ff = _mm256_set1_epi8('\f');
+  for (; end - p >= 32; p += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i blank = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space),
+                      _mm256_cmpeq_epi8(bytes, tab)),
+      _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, cr),
+                                      _mm256_cmpeq_epi8(bytes, vt)),
+                      _mm256_cmpeq_epi8(bytes, ff)));
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return skip_blanks_sse2(p, end);
+}
+
+
+__attribute__((SCAN_OPTIMIZE target("avx2")))
+const char* find_any_avx2(const char* p, const char* end, char a, char b,
+                          char c)
+{
+  const __m256i va = _mm256_set1_epi8(a);
+  const __m256i vb = _mm256_set1_epi8(b);
+  const __m256i vc = _mm256_set1_epi8(c);
+  for (; end - p >= 32; p += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i found = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(bytes, va),
+                      _mm256_cmpeq_epi8(bytes, vb)),
+      _mm256_cmpeq_epi8(bytes, vc));
+    unsigned mask = _mm256_movemask_epi8(found);
+    if (mask)
+      return p + __builtin_ctz(mask);
+  }
+  return find_any_sse2(p, end, a, b, c);
+}
+
+#endif
+
+
+//----------------------------------------------------------------------
+// DISPATCH
+//----------------------------------------------------------------------
+
+// every implementation (slowest first) and whether the cpu supports it
+const ByteScanner BYTE_SCANNERS[] = {
+  {"scalar", skip_blanks_scalar, find_any_scalar},
+#ifdef MYPL_X86_SCAN
+  {"sse2", skip_blanks_sse2, find_any_sse2},
+  {"avx2", skip_blanks_avx2, find_any_avx2},
+#endif
+};
+
+
+bool byte_scanner_supported(const ByteScanner& scanner)
+{
+#ifdef MYPL_X86_SCAN
+  std::string name = scanner.name;
+  if (name == "sse2")
+    return __builtin_cpu_supports("sse2");
+  if (name == "avx2")
+    return __builtin_cpu_supports("avx2");
+#endif
+  return true;
+}
+
+
+// the selected scanner (null until first use)
+const ByteScanner* current_byte_scanner = nullptr;
+
+
+const ByteScanner& byte_scanner()
+{
+  if (!current_byte_scanner) {
+    for (const ByteScanner& scanner : BYTE_SCANNERS)
+      if (byte_scanner_supported(scanner))
+        current_byte_scanner = &scanner;
+  }
+  return *current_byte_scanner;
+}
+
+
+bool select_byte_scanner(const std::string& name)
+{
+  for (const ByteScanner& scanner : BYTE_SCANNERS) {
+    if (name == scanner.name and byte_scanner_supported(scanner)) {
+      current_byte_scanner = &scanner;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+std::vector<std::string> byte_scanner_names()
+{
+  std::vector<std::string> names;
+  for (const ByteScanner& scanner : BYTE_SCANNERS)
+    if (byte_scanner_supported(scanner))
+      names.push_back(scanner.name);
+  return names;
+}
+
+
+#endif
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: bytecode.h
+// DATE: Oct 16, 2026
+// DESC: Register-based bytecode for the MyPL virtual machine. Each
+//       function (and each user-defined type initializer) is compiled
+//       into a Chunk of fixed-size instructions that operate on a
+//       window of registers. Constants and type layouts are shared
+//       through the Module.
+//----------------------------------------------------------------------
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <string>
+#include <vector>
+#include "data_object.h"
+
+
+// vm instructions (R = registers, K = constants, F = field offsets
+// within an object's shape, pc = jump target within the current chunk)
+enum OpCode {
+  // moves and constants
+  OP_MOVE,          // R[a] = R[b]
+  OP_LOADK,         // R[a] = K[b]
+  OP_LOADNIL,       // R[a] = nil
+  // arithmetic
+  OP_ADD,           // R[a] = R[b] + R[c]
+  OP_SUB,           // R[a] = R[b] - R[c]
+  OP_MUL,           // R[a] = R[b] * R[c]
+  OP_DIV,           // R[a] = R[b] / R[c]
+  OP_MOD,           // R[a] = R[b] % R[c]
+  OP_ADDI,          // R[a] = R[b] + c (int immediate)
+  // comparison and logical operators
+  OP_LT,            // R[a] = R[b] < R[c]
+  OP_LE,            // R[a] = R[b] <= R[c]
+  OP_GT,            // R[a] = R[b] > R[c]
+  OP_GE,            // R[a] = R[b] >= R[c]
+  OP_EQ,            // R[a] = R[b] == R[c]
+  OP_NE,            // R[a] = R[b] != R[c]
+  OP_AND,           // R[a] = R[b] and R[c]
+  OP_OR,            // R[a] = R[b] or R[c]
+  OP_NOT,           // R[a] = not R[b]
+  OP_NEG,           // R[a] = neg R[b]
+  // control flow
+  OP_JMP,           // pc = a
+  OP_JMPF,          // if not R[a] then pc = b
+  OP_JNLT,          // if not R[a] < R[b] then pc = c
+  OP_JNLE,          // if not R[a] <= R[b] then pc = c
+  OP_JNGT,          // if not R[a] > R[b] then pc = c
+  OP_JNGE,          // if not R[a] >= R[b] then pc = c
+  OP_JNEQ,          // if not R[a] == R[b] then pc = c
+  OP_JNNE,          // if not R[a] != R[b] then pc = c
+  OP_FORLOOP,       // R[a] = R[a] + 1; if R[a] <= R[b] then pc = c
+  // function calls
+  OP_CALL,          // R[a] = chunk b (R[a], ..., R[a+c-1])
+  OP_TAILCALL,      // return chunk b (R[a], ..., R[a+c-1]) in this frame
+  OP_BUILTIN,       // R[a] = builtin b (R[a], ..., R[a+c-1])
+  OP_RET,           // return R[a]
+  OP_RETNIL,        // return nil
+  // user-defined types
+  OP_MKOBJ,         // R[a] = new object of type b from R[0], R[1], ...
+  OP_GETF,          // R[a] = R[b].F[c]
+  OP_SETF,          // R[a].F[b] = R[c]
+  // number of opcodes (not an instruction)
+  OP_COUNT
+};
+
+
+// built-in functions callable through OP_BUILTIN
+enum BuiltIn {
+  BI_PRINT, BI_ITOS, BI_DTOS, BI_STOI, BI_STOD, BI_LENGTH, BI_GET, BI_READ,
+  BI_FLUSH
+};
+
+
+// a single fixed-size instruction
+struct Instr
+{
+  int op;
+  int a;
+  int b;
+  int c;
+};
+
+
+// the compiled code of a function or a type initializer
+struct Chunk
+{
+  std::string name;             // function (or type) name
+  std::vector<Instr> code;      // instructions
+  int num_params = 0;           // parameters occupy the first registers
+  int num_regs = 1;             // size of the register window
+};
+
+
+// the field layout (shape) of a user-defined type
+struct TypeLayout
+{
+  std::string name;             // type name
+  std::vector<std::string> fields; // field names in offset order
+  int init_chunk = -1;          // chunk that builds a new object
+};
+
+
+// a compiled program
+struct Module
+{
+  std::vector<Chunk> chunks;        // functions and type initializers
+  std::vector<DataObject> constants; // constant pool
+  std::vector<TypeLayout> types;    // user-defined types
+  int main_chunk = -1;              // entry point
+
+  // give a string representation (disassembly) for printing/testing
+  std::string to_string() const;
+};
+
+
+//----------------------------------------------------------------------
+// DISASSEMBLY
+//----------------------------------------------------------------------
+
+std::string Module::to_string() const
+{
+  static const char* op_names[] = {
+    "MOVE", "LOADK", "LOADNIL", "ADD", "SUB", "MUL", "DIV", "MOD", "ADDI",
+    "LT", "LE", "GT", "GE", "EQ", "NE", "AND", "OR", "NOT", "NEG",
+    "JMP", "JMPF", "JNLT", "JNLE", "JNGT", "JNGE", "JNEQ", "JNNE",
+    "FORLOOP", "CALL", "TAILCALL", "BUILTIN", "RET", "RETNIL", "MKOBJ", "GETF", "SETF"
+  };
+  static_assert(sizeof(op_names) / sizeof(op_names[0]) == OP_COUNT,
+                "missing opcode name");
+  std::string s = "";
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const Chunk& chunk = chunks[i];
+    s += "chunk " + std::to_string(i) + " '" + chunk.name + "' params " +
+      std::to_string(chunk.num_params) + " regs " +
+      std::to_string(chunk.num_regs) + ":\n";
+    for (size_t pc = 0; pc < chunk.code.size(); ++pc) {
+      const Instr& instr = chunk.code[pc];
+      s += "  " + std::to_string(pc) + "\t" + op_names[instr.op] + "\t" +
+        std::to_string(instr.a) + " " + std::to_string(instr.b) + " " +
+        std::to_string(instr.c);
+      if (instr.op == OP_LOADK)
+        s += "\t; " + constants[instr.b].to_string();
+      s += "\n";
+    }
+  }
+  return s;
+}
+
+
+#endif
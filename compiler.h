@@ -0,0 +1,680 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: compiler.h
+// DATE: Oct 16, 2026
+// DESC: Compiles a type-checked AST into register bytecode for the
+//       MyPL virtual machine. Local variables live in fixed registers
+//       of their function's window and temporaries are allocated
+//       above them in stack order. Common patterns are compiled to
+//       superinstructions (ADDI for x + k, compare-and-branch for
+//       conditions, and FORLOOP for the for-loop step).
+//----------------------------------------------------------------------
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+#include "bytecode.h"
+
+
+class Compiler : public Visitor
+{
+public:
+
+  // create a compiler that writes into the given module
+  Compiler(Module& module) : module(module) {}
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+private:
+
+  // the module being built
+  Module& module;
+
+  // the chunk currently being compiled
+  Chunk* chunk = nullptr;
+
+  // the register the current expression is compiled into (-1 if
+  // the value is not needed)
+  int dest = -1;
+
+  // next free register and the local variable scopes of the chunk
+  int next_reg = 0;
+  std::vector<std::map<std::string,int>> scopes;
+
+  // function, type, built-in and constant lookup tables
+  std::unordered_map<std::string,int> functions;
+  std::unordered_map<std::string,int> types;
+  std::unordered_map<std::string,int> built_ins;
+  std::map<std::string,int> constant_index;
+
+  // chunk helpers
+  void begin_chunk(int chunk_index);
+  int emit(int op, int a = 0, int b = 0, int c = 0);
+  int pc() const;
+  void patch(int instr_index, int target);
+
+  // register and scope helpers
+  int new_reg();
+  void push_scope();
+  void pop_scope();
+  void declare(const std::string& name, int reg);
+  int local_reg(const Token& id);
+
+  // constant helper
+  int constant(const DataObject& val, const std::string& key);
+
+  // expression helpers
+  void compile_expr(Expr* expr, int target);
+  int operand(Expr* expr);
+  int operand(ExprTerm* term);
+  bool is_local(ExprTerm* term, int& reg);
+  bool is_int_literal(Expr* expr, int& val);
+  void binary_op(Expr& node, int target, int lhs);
+  int branch_if_false(Expr* cond);
+  void stmts(Span<Stmt*>& stmt_list);
+
+  // error message
+  void error(const std::string& msg, const Token& token);
+  void error(const std::string& msg);
+};
+
+
+void Compiler::error(const std::string& msg, const Token& token)
+{
+  throw MyPLException(RUNTIME, msg, token.line(), token.column());
+}
+
+
+void Compiler::error(const std::string& msg)
+{
+  throw MyPLException(RUNTIME, msg);
+}
+
+
+//----------------------------------------------------------------------
+// HELPER FUNCTIONS
+//----------------------------------------------------------------------
+
+void Compiler::begin_chunk(int chunk_index)
+{
+  chunk = &module.chunks[chunk_index];
+  next_reg = 0;
+  scopes.clear();
+  push_scope();
+}
+
+
+int Compiler::emit(int op, int a, int b, int c)
+{
+  chunk->code.push_back(Instr {op, a, b, c});
+  return chunk->code.size() - 1;
+}
+
+
+int Compiler::pc() const
+{
+  return chunk->code.size();
+}
+
+
+void Compiler::patch(int instr_index, int target)
+{
+  Instr& instr = chunk->code[instr_index];
+  if (instr.op == OP_JMP)
+    instr.a = target;
+  else if (instr.op == OP_JMPF)
+    instr.b = target;
+  else
+    instr.c = target;
+}
+
+
+int Compiler::new_reg()
+{
+  int reg = next_reg++;
+  if (next_reg > chunk->num_regs)
+    chunk->num_regs = next_reg;
+  return reg;
+}
+
+
+void Compiler::push_scope()
+{
+  scopes.push_back(std::map<std::string,int>());
+}
+
+
+void Compiler::pop_scope()
+{
+  scopes.pop_back();
+}
+
+
+void Compiler::declare(const std::string& name, int reg)
+{
+  scopes.back()[name] = reg;
+}
+
+
+int Compiler::local_reg(const Token& id)
+{
+  for (size_t i = scopes.size(); i > 0; --i) {
+    auto it = scopes[i-1].find(id.lexeme());
+    if (it != scopes[i-1].end())
+      return it->second;
+  }
+  error("undefined variable '" + id.lexeme() + "'", id);
+  return -1;
+}
+
+
+int Compiler::constant(const DataObject& val, const std::string& key)
+{
+  auto it = constant_index.find(key);
+  if (it != constant_index.end())
+    return it->second;
+  module.constants.push_back(val);
+  int index = module.constants.size() - 1;
+  constant_index[key] = index;
+  return index;
+}
+
+
+// compile the expression so that its value ends up in target
+void Compiler::compile_expr(Expr* expr, int target)
+{
+  int saved_dest = dest;
+  dest = target;
+  expr->accept(*this);
+  dest = saved_dest;
+}
+
+
+// return a register holding the value of the expression, compiling
+// it into a new temporary unless it is a plain local variable
+int Compiler::operand(Expr* expr)
+{
+  if (!expr->negated and !expr->op)
+    return operand(expr->first);
+  int reg = new_reg();
+  compile_expr(expr, reg);
+  return reg;
+}
+
+
+int Compiler::operand(ExprTerm* term)
+{
+  int reg = -1;
+  if (is_local(term, reg))
+    return reg;
+  reg = new_reg();
+  int saved_dest = dest;
+  dest = reg;
+  term->accept(*this);
+  dest = saved_dest;
+  return reg;
+}
+
+
+// true if the term is a single (non-path) variable
+bool Compiler::is_local(ExprTerm* term, int& reg)
+{
+  SimpleTerm* simple = dynamic_cast<SimpleTerm*>(term);
+  if (!simple)
+    return false;
+  IDRValue* id = dynamic_cast<IDRValue*>(simple->rvalue);
+  if (!id or id->path.size() != 1)
+    return false;
+  reg = local_reg(id->path.front());
+  return true;
+}
+
+
+// true if the expression is a single int literal
+bool Compiler::is_int_literal(Expr* expr, int& val)
+{
+  if (expr->negated or expr->op)
+    return false;
+  SimpleTerm* simple = dynamic_cast<SimpleTerm*>(expr->first);
+  if (!simple)
+    return false;
+  SimpleRValue* literal = dynamic_cast<SimpleRValue*>(simple->rvalue);
+  if (!literal or literal->value.type() != INT_VAL)
+    return false;
+  try {
+    val = std::stoi(literal->value.lexeme());
+  } catch (const std::exception& e) {
+    return false;
+  }
+  return true;
+}
+
+
+// emit a (to be patched) jump that is taken when cond is false,
+// returning the index of the jump instruction
+int Compiler::branch_if_false(Expr* cond)
+{
+  int mark = next_reg;
+  int jump = -1;
+  if (!cond->negated and cond->op) {
+    TokenType op = cond->op->type();
+    int branch_op = -1;
+    if (op == LESS) branch_op = OP_JNLT;
+    else if (op == LESS_EQUAL) branch_op = OP_JNLE;
+    else if (op == GREATER) branch_op = OP_JNGT;
+    else if (op == GREATER_EQUAL) branch_op = OP_JNGE;
+    else if (op == EQUAL) branch_op = OP_JNEQ;
+    else if (op == NOT_EQUAL) branch_op = OP_JNNE;
+    if (branch_op != -1) {
+      int lhs = operand(cond->first);
+      int rhs = operand(cond->rest);
+      jump = emit(branch_op, lhs, rhs, -1);
+    }
+  }
+  if (jump == -1)
+    jump = emit(OP_JMPF, operand(cond), -1);
+  next_reg = mark;
+  return jump;
+}
+
+
+void Compiler::stmts(Span<Stmt*>& stmt_list)
+{
+  push_scope();
+  int mark = next_reg;
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+  next_reg = mark;
+  pop_scope();
+}
+
+
+//----------------------------------------------------------------------
+// TOP-LEVEL
+//----------------------------------------------------------------------
+
+void Compiler::visit(Program& node)
+{
+  built_ins = {{"print", BI_PRINT}, {"itos", BI_ITOS}, {"dtos", BI_DTOS},
+               {"stoi", BI_STOI}, {"stod", BI_STOD}, {"length", BI_LENGTH},
+               {"get", BI_GET}, {"read", BI_READ}, {"flush", BI_FLUSH}};
+
+  // assign chunks up front so calls can refer to any function
+  for (Decl* d : node.decls) {
+    FunDecl* fun_decl = dynamic_cast<FunDecl*>(d);
+    TypeDecl* type_decl = dynamic_cast<TypeDecl*>(d);
+    Chunk chunk;
+    if (fun_decl) {
+      chunk.name = fun_decl->id.lexeme();
+      functions[chunk.name] = module.chunks.size();
+    }
+    else {
+      chunk.name = type_decl->id.lexeme();
+      TypeLayout layout;
+      layout.name = chunk.name;
+      layout.init_chunk = module.chunks.size();
+      for (VarDeclStmt* v : type_decl->vdecls)
+        layout.fields.push_back(v->id.lexeme());
+      types[chunk.name] = module.types.size();
+      module.types.push_back(layout);
+    }
+    module.chunks.push_back(chunk);
+  }
+
+  for (Decl* d : node.decls)
+    d->accept(*this);
+
+  if (functions.count("main") == 0)
+    error("undefined 'main' function");
+  module.main_chunk = functions["main"];
+}
+
+
+void Compiler::visit(FunDecl& node)
+{
+  begin_chunk(functions[node.id.lexeme()]);
+  // parameters are passed in the first registers
+  for (FunDecl::FunParam& param : node.params)
+    declare(param.id.lexeme(), new_reg());
+  chunk->num_params = node.params.size();
+  for (Stmt* s : node.stmts)
+    s->accept(*this);
+  emit(OP_RETNIL);
+}
+
+
+void Compiler::visit(TypeDecl& node)
+{
+  int type_index = types[node.id.lexeme()];
+  begin_chunk(module.types[type_index].init_chunk);
+  // each field initializer is compiled as a local variable, so the
+  // field values end up in registers 0..n-1 before the object is built
+  for (VarDeclStmt* v : node.vdecls)
+    v->accept(*this);
+  emit(OP_MKOBJ, 0, type_index);
+  emit(OP_RET, 0);
+}
+
+
+//----------------------------------------------------------------------
+// STATEMENTS
+//----------------------------------------------------------------------
+
+void Compiler::visit(VarDeclStmt& node)
+{
+  int reg = new_reg();
+  compile_expr(node.expr, reg);
+  next_reg = reg + 1;
+  declare(node.id.lexeme(), reg);
+}
+
+
+void Compiler::visit(AssignStmt& node)
+{
+  int mark = next_reg;
+  int reg = local_reg(node.lvalue_list.front());
+  if (node.lvalue_list.size() == 1) {
+    // i = i + k is a single in-place ADDI
+    compile_expr(node.expr, reg);
+  }
+  else {
+    // walk the path up to the object that owns the assigned field
+    int obj = reg;
+    for (size_t f = 0; f + 1 < node.fields.size(); ++f) {
+      int next_obj = new_reg();
+      emit(OP_GETF, next_obj, obj, node.fields[f]);
+      obj = next_obj;
+    }
+    int val = operand(node.expr);
+    emit(OP_SETF, obj, node.fields.back(), val);
+  }
+  next_reg = mark;
+}
+
+
+void Compiler::visit(ReturnStmt& node)
+{
+  int mark = next_reg;
+  emit(OP_RET, operand(node.expr));
+  next_reg = mark;
+}
+
+
+void Compiler::visit(IfStmt& node)
+{
+  std::list<int> end_jumps;
+  bool more = !node.else_ifs.empty() or !node.body_stmts.empty();
+  // if part
+  int skip = branch_if_false(node.if_part->expr);
+  stmts(node.if_part->stmts);
+  if (more)
+    end_jumps.push_back(emit(OP_JMP, -1));
+  patch(skip, pc());
+  // else ifs
+  size_t i = 0;
+  for (BasicIf* b : node.else_ifs) {
+    ++i;
+    skip = branch_if_false(b->expr);
+    stmts(b->stmts);
+    if (i < node.else_ifs.size() or !node.body_stmts.empty())
+      end_jumps.push_back(emit(OP_JMP, -1));
+    patch(skip, pc());
+  }
+  // else part
+  if (!node.body_stmts.empty())
+    stmts(node.body_stmts);
+  for (int jump : end_jumps)
+    patch(jump, pc());
+}
+
+
+void Compiler::visit(WhileStmt& node)
+{
+  int top = pc();
+  int exit = branch_if_false(node.expr);
+  stmts(node.stmts);
+  emit(OP_JMP, top);
+  patch(exit, pc());
+}
+
+
+void Compiler::visit(ForStmt& node)
+{
+  int mark = next_reg;
+  push_scope();
+  // the hidden counter drives the loop, the loop variable gets a copy
+  // each iteration (so the body can assign to it freely)
+  int counter = new_reg();
+  int end = new_reg();
+  int var = new_reg();
+  compile_expr(node.start, counter);
+  emit(OP_MOVE, var, counter);
+  declare(node.var_id.lexeme(), var);
+  compile_expr(node.end, end);
+  int exit = emit(OP_JNLE, counter, end, -1);
+  int top = pc();
+  emit(OP_MOVE, var, counter);
+  stmts(node.stmts);
+  emit(OP_FORLOOP, counter, end, top);
+  patch(exit, pc());
+  pop_scope();
+  next_reg = mark;
+}
+
+
+//----------------------------------------------------------------------
+// EXPRESSIONS
+//----------------------------------------------------------------------
+
+void Compiler::visit(Expr& node)
+{
+  int target = dest;
+  if (node.negated) {
+    node.first->accept(*this);
+    emit(OP_NOT, target, target);
+    return;
+  }
+  if (!node.op) {
+    node.first->accept(*this);
+    return;
+  }
+  // a chain of left operands ((a op b) op c) op ... is compiled
+  // innermost first into one accumulator instead of recursively (the
+  // accumulator is a new temporary since target may be a local that is
+  // still read by a later operand)
+  std::vector<Expr*> chain;
+  for (Expr* e = &node; e; e = e->left_expr())
+    chain.push_back(e);
+  int mark = next_reg;
+  int lhs = -1;
+  if (chain.size() == 1)
+    lhs = operand(node.first);
+  else {
+    lhs = new_reg();
+    compile_expr(chain.back(), lhs);
+    chain.pop_back();
+  }
+  int level_mark = next_reg;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    binary_op(**it, *it == &node ? target : lhs, lhs);
+    next_reg = level_mark;
+  }
+  next_reg = mark;
+}
+
+
+// emit one level of an expression: target = lhs op rest
+void Compiler::binary_op(Expr& node, int target, int lhs)
+{
+  TokenType op = node.op->type();
+  int k = 0;
+  if ((op == PLUS or op == MINUS) and is_int_literal(node.rest, k)) {
+    emit(OP_ADDI, target, lhs, op == PLUS ? k : -k);
+    return;
+  }
+  int rhs = operand(node.rest);
+  int code = -1;
+  switch (op) {
+    case PLUS: code = OP_ADD; break;
+    case MINUS: code = OP_SUB; break;
+    case MULTIPLY: code = OP_MUL; break;
+    case DIVIDE: code = OP_DIV; break;
+    case MODULO: code = OP_MOD; break;
+    case LESS: code = OP_LT; break;
+    case LESS_EQUAL: code = OP_LE; break;
+    case GREATER: code = OP_GT; break;
+    case GREATER_EQUAL: code = OP_GE; break;
+    case EQUAL: code = OP_EQ; break;
+    case NOT_EQUAL: code = OP_NE; break;
+    case AND: code = OP_AND; break;
+    case OR: code = OP_OR; break;
+    default: error("Operator Error in expression", *node.op);
+  }
+  emit(code, target, lhs, rhs);
+}
+
+
+void Compiler::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+}
+
+
+void Compiler::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Compiler::visit(SimpleRValue& node)
+{
+  std::string lexeme = node.value.lexeme();
+  TokenType type = node.value.type();
+  if (type == NIL) {
+    emit(OP_LOADNIL, dest);
+    return;
+  }
+  DataObject val;
+  if (type == CHAR_VAL)
+    val.set(lexeme.at(0));
+  else if (type == STRING_VAL)
+    val.set(lexeme);
+  else if (type == BOOL_VAL)
+    val.set(lexeme == "true");
+  else if (type == INT_VAL) {
+    try {
+      val.set(std::stoi(lexeme));
+    }
+    catch (const std::invalid_argument& e) {
+      error("internal error", node.value);
+    }
+    catch (const std::out_of_range& e) {
+      error("int out of range", node.value);
+    }
+  }
+  else if (type == DOUBLE_VAL) {
+    try {
+      val.set(std::stod(lexeme));
+    }
+    catch (const std::invalid_argument& e) {
+      error("internal error", node.value);
+    }
+    catch (const std::out_of_range& e) {
+      error("double out of range", node.value);
+    }
+  }
+  else
+    error("Simple R Value invalid value", node.value);
+  emit(OP_LOADK, dest, constant(val, val.to_string_type() + ":" + lexeme));
+}
+
+
+void Compiler::visit(NewRValue& node)
+{
+  int type_index = types[node.type_id.lexeme()];
+  int base = new_reg();
+  emit(OP_CALL, base, module.types[type_index].init_chunk, 0);
+  if (dest != -1 and dest != base)
+    emit(OP_MOVE, dest, base);
+}
+
+
+void Compiler::visit(CallExpr& node)
+{
+  int target = dest;
+  int mark = next_reg;
+  // arguments are placed in consecutive registers at the top of the
+  // window, which becomes the callee's window
+  int base = next_reg;
+  int arg_count = node.arg_list.size();
+  for (int i = 0; i < std::max(arg_count, 1); ++i)
+    new_reg();
+  int i = 0;
+  for (Expr* e : node.arg_list)
+    compile_expr(e, base + i++);
+  std::string fun_name = node.function_id.lexeme();
+  if (built_ins.count(fun_name))
+    emit(OP_BUILTIN, base, built_ins[fun_name], arg_count);
+  else if (functions.count(fun_name) and node.tail)
+    emit(OP_TAILCALL, base, functions[fun_name], arg_count);
+  else if (functions.count(fun_name))
+    emit(OP_CALL, base, functions[fun_name], arg_count);
+  else
+    error("undefined function '" + fun_name + "'", node.function_id);
+  if (target != -1 and target != base)
+    emit(OP_MOVE, target, base);
+  next_reg = mark;
+}
+
+
+void Compiler::visit(IDRValue& node)
+{
+  auto it = node.path.begin();
+  int reg = local_reg(*it);
+  if (node.path.size() == 1) {
+    if (dest != reg)
+      emit(OP_MOVE, dest, reg);
+    return;
+  }
+  for (int field : node.fields) {
+    emit(OP_GETF, dest, reg, field);
+    reg = dest;
+  }
+}
+
+
+void Compiler::visit(NegatedRValue& node)
+{
+  compile_expr(node.expr, dest);
+  emit(OP_NEG, dest, dest);
+}
+
+
+#endif
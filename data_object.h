@@ -35,6 +35,9 @@ public:
   // copying
   DataObject(const DataObject& rhs);
   DataObject& operator=(const DataObject& rhs);
+  // moving
+  DataObject(DataObject&& rhs) noexcept;
+  DataObject& operator=(DataObject&& rhs) noexcept;
   // set/update
   void set(int val);
   void set(double val);
@@ -64,11 +67,25 @@ public:
   std::string to_string() const;
   std::string to_string_type() const;
  private:
-  void* value_ptr = nullptr;
+  // scalars are stored inline, only strings live on the heap
+  union {
+    int int_val;
+    double double_val;
+    char char_val;
+    bool bool_val;
+    size_t oid_val;
+    std::string* str_ptr;
+  };
   DataType value_type = DataType::NIL;
   void delete_obj();
+  // copy the active scalar member of rhs (not its string)
+  void copy_scalar(const DataObject& rhs);
 };
 
+// the union holds at most a double, so a value is its scalar plus a tag
+static_assert(sizeof(DataObject) <= 2 * sizeof(double),
+              "DataObject scalars must be stored inline");
+
 
 
 //----------------------------------------------------------------------
@@ -76,43 +93,43 @@ public:
 //----------------------------------------------------------------------
 
 DataObject::DataObject()
+  : str_ptr(nullptr)
 {
-  set_nil();
 }
 
 DataObject::DataObject(int val)
+  : int_val(val), value_type(DataType::INTEGER)
 {
-  set(val);
 }
 
 DataObject::DataObject(double val)
+  : double_val(val), value_type(DataType::DOUBLE)
 {
-  set(val);
 }
 
 DataObject::DataObject(const char* val)
+  : str_ptr(new std::string(val)), value_type(DataType::STRING)
 {
-  set(std::string(val));
 }
 
 DataObject::DataObject(const std::string& val)
+  : str_ptr(new std::string(val)), value_type(DataType::STRING)
 {
-  set(val);
 }
 
 DataObject::DataObject(char val)
+  : char_val(val), value_type(DataType::CHAR)
 {
-  set(val);
 }
 
 DataObject::DataObject(bool val)
+  : bool_val(val), value_type(DataType::BOOL)
 {
-  set(val);
 }
 
 DataObject::DataObject(size_t val)
+  : oid_val(val), value_type(DataType::OID)
 {
-  set(val);
 }
 
 
@@ -121,18 +138,9 @@ DataObject::DataObject(size_t val)
 //----------------------------------------------------------------------
 void DataObject::delete_obj()
 {
-  if (value_type == DataType::INTEGER)
-    delete (int*)value_ptr;
-  else if (value_type == DataType::DOUBLE)
-    delete (double*)value_ptr;
-  else if (value_type == DataType::STRING)
-    delete (std::string*)value_ptr;
-  else if (value_type == DataType::CHAR)
-    delete (char*)value_ptr;
-  else if (value_type == DataType::BOOL)
-    delete (bool*)value_ptr;
-  else if (value_type == DataType::OID)
-    delete (size_t*)value_ptr;
+  if (value_type == DataType::STRING)
+    delete str_ptr;
+  value_type = DataType::NIL;
 }
 
 DataObject::~DataObject()
@@ -145,52 +153,66 @@ DataObject::~DataObject()
 // COPYING
 //----------------------------------------------------------------------
 
+void DataObject::copy_scalar(const DataObject& rhs)
+{
+  switch (rhs.value_type) {
+    case DataType::INTEGER: int_val = rhs.int_val; break;
+    case DataType::DOUBLE: double_val = rhs.double_val; break;
+    case DataType::CHAR: char_val = rhs.char_val; break;
+    case DataType::BOOL: bool_val = rhs.bool_val; break;
+    case DataType::OID: oid_val = rhs.oid_val; break;
+    case DataType::STRING: str_ptr = rhs.str_ptr; break;
+    case DataType::NIL: break;
+  }
+}
+
 DataObject::DataObject(const DataObject& rhs)
+  : value_type(rhs.value_type)
 {
-  *this = rhs;
+  if (value_type == DataType::STRING)
+    str_ptr = new std::string(*rhs.str_ptr);
+  else
+    copy_scalar(rhs);
 }
 
 DataObject& DataObject::operator=(const DataObject& rhs)
 {
   if (this == &rhs)
     return *this;
-  if (rhs.is_integer()) {
-    int v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_double()) {
-    double v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_string()) {
-    std::string v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_char()) {
-    char v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_bool()) {
-    bool v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_oid()) {
-    size_t v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_nil()) {
-    set_nil();
+  if (rhs.value_type == DataType::STRING)
+    set(*rhs.str_ptr);
+  else {
+    delete_obj();
+    copy_scalar(rhs);
+    value_type = rhs.value_type;
   }
   return *this;
 }
 
 
+//----------------------------------------------------------------------
+// MOVING
+//----------------------------------------------------------------------
+
+DataObject::DataObject(DataObject&& rhs) noexcept
+  : value_type(rhs.value_type)
+{
+  copy_scalar(rhs);
+  rhs.value_type = DataType::NIL;
+}
+
+DataObject& DataObject::operator=(DataObject&& rhs) noexcept
+{
+  if (this == &rhs)
+    return *this;
+  delete_obj();
+  copy_scalar(rhs);
+  value_type = rhs.value_type;
+  rhs.value_type = DataType::NIL;
+  return *this;
+}
+
+
 //----------------------------------------------------------------------
 // SET/UPDATE
 //----------------------------------------------------------------------
@@ -198,64 +220,61 @@ DataObject& DataObject::operator=(const DataObject& rhs)
 void DataObject::set(int val)
 {
   delete_obj();
-  value_ptr = new int;
-  *((int*)value_ptr) = val;
+  int_val = val;
   value_type = DataType::INTEGER;
 }
 
 void DataObject::set(double val)
 {
   delete_obj();
-  value_ptr = new double;
-  *((double*)value_ptr) = val;
+  double_val = val;
   value_type = DataType::DOUBLE;
 }
 
 void DataObject::set(const char* val)
 {
-  delete_obj();
-  value_ptr = new std::string;
-  *((std::string*)value_ptr) = val;
+  if (value_type == DataType::STRING) {
+    *str_ptr = val;
+    return;
+  }
+  str_ptr = new std::string(val);
   value_type = DataType::STRING;
 }
 
 void DataObject::set(const std::string& val)
 {
-  delete_obj();
-  value_ptr = new std::string;
-  *((std::string*)value_ptr) = val;
+  if (value_type == DataType::STRING) {
+    *str_ptr = val;
+    return;
+  }
+  str_ptr = new std::string(val);
   value_type = DataType::STRING;
 }
 
 void DataObject::set(char val)
 {
   delete_obj();
-  value_ptr = new char;
-  *((char*)value_ptr) = val;
+  char_val = val;
   value_type = DataType::CHAR;
 }
 
 void DataObject::set(bool val)
 {
   delete_obj();
-  value_ptr = new bool;
-  *((bool*)value_ptr) = val;
+  bool_val = val;
   value_type = DataType::BOOL;
 }
 
 void DataObject::set(size_t val)
 {
   delete_obj();
-  value_ptr = new size_t;
-  *((size_t*)value_ptr) = val;
+  oid_val = val;
   value_type = DataType::OID;
 }
 
 void DataObject::set_nil() 
 {
   delete_obj();
-  value_ptr = nullptr;
-  value_type = DataType::NIL;
 }
 
 
@@ -310,49 +329,49 @@ bool DataObject::is_oid() const
 
 bool DataObject::value(int& val) const
 {
-  if (value_type != DataType::INTEGER or !value_ptr)
+  if (value_type != DataType::INTEGER)
     return false;
-  val = *((int*)value_ptr);
+  val = int_val;
   return true;
 }
 
 bool DataObject::value(double& val) const
 {
-  if (value_type != DataType::DOUBLE or !value_ptr)
+  if (value_type != DataType::DOUBLE)
     return false;
-  val = *((double*)value_ptr);
+  val = double_val;
   return true;
 }
 
 bool DataObject::value(std::string& val) const
 {
-  if (value_type != DataType::STRING or !value_ptr)
+  if (value_type != DataType::STRING)
     return false;
-  val = *((std::string*)value_ptr);
+  val = *str_ptr;
   return true;
 }
 
 bool DataObject::value(char& val) const
 {
-  if (value_type != DataType::CHAR or !value_ptr)
+  if (value_type != DataType::CHAR)
     return false;
-  val = *((char*)value_ptr);
+  val = char_val;
   return true;
 }
 
 bool DataObject::value(bool& val) const
 {
-  if (value_type != DataType::BOOL or !value_ptr)
+  if (value_type != DataType::BOOL)
     return false;
-  val = *((bool*)value_ptr);
+  val = bool_val;
   return true;
 }
 
 bool DataObject::value(size_t& val) const  
 {
-  if (value_type != DataType::OID or !value_ptr)
+  if (value_type != DataType::OID)
     return false;
-  val = *((size_t*)value_ptr);
+  val = oid_val;
   return true;
 }
 
@@ -363,26 +382,26 @@ bool DataObject::value(size_t& val) const
 
 std::string DataObject::to_string() const
 {
-  if (!value_ptr or value_type == DataType::NIL)
+  if (value_type == DataType::NIL)
     return "";
   else if (value_type == DataType::INTEGER)
-    return std::to_string(*((int*)value_ptr));
+    return std::to_string(int_val);
   else if (value_type == DataType::DOUBLE)
-    return std::to_string(*((double*)value_ptr));
+    return std::to_string(double_val);
   else if (value_type == DataType::STRING)
-    return *((std::string*)value_ptr);
+    return *str_ptr;
   else if (value_type == DataType::CHAR)
-    return std::to_string(*((char*)value_ptr));
+    return std::to_string(char_val);
   else if (value_type == DataType::BOOL)
-    return std::to_string(*((bool*)value_ptr));
+    return std::to_string(bool_val);
   else if (value_type == DataType::OID)
-    return std::to_string(*((size_t*)value_ptr));
+    return std::to_string(oid_val);
   return "";
 }
 
 std::string DataObject::to_string_type() const
 {
-  if (!value_ptr or value_type == DataType::NIL)
+  if (value_type == DataType::NIL)
     return "nil";
   else if (value_type == DataType::INTEGER)
     return "int";
@@ -0,0 +1,46 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: front_end.h
+// DATE: Oct 16, 2026
+// DESC: The passes that turn a parsed program into the checked program
+//       the interpreter, the compiler, and the ast cache work from:
+//       type checking, inlining, variable resolution, and constant
+//       folding. Every tool runs them through check_program, so the
+//       ast cache stamp (a hash of the front-end sources, this file
+//       included) changes whenever the pipeline does.
+//----------------------------------------------------------------------
+
+#ifndef FRONT_END_H
+#define FRONT_END_H
+
+#include "ast.h"
+#include "type_checker.h"
+#include "inliner.h"
+#include "resolver.h"
+#include "optimizer.h"
+
+
+// type check (with function bodies checked on the given number of
+// threads), resolve the variables of, and (unless optimize is false)
+// optimize the parsed program, inlining functions of up to
+// inline_budget nodes
+void check_program(Program& program, bool optimize = true,
+                   int inline_budget = DEFAULT_INLINE_BUDGET,
+                   unsigned threads = 1)
+{
+  TypeChecker type_checker(threads);
+  program.accept(type_checker);
+  if (optimize) {
+    Inliner inliner(inline_budget);
+    program.accept(inliner);
+  }
+  Resolver resolver;
+  program.accept(resolver);
+  if (optimize) {
+    Optimizer optimizer;
+    program.accept(optimizer);
+  }
+}
+
+
+#endif
@@ -4,17 +4,25 @@
 // Date: Spring 2021
 // Desc: Basic Heap implementation for the MyPL Interpreter. The Heap
 //       is used to store objects of user-defined types. Each object
-//       has a unique object id (OID) and a collection of key-value
-//       pairs. The keys denote user-defined type variable names and
-//       the values denote the corresponding variable values. Each
-//       value is represented as a DataObject. The key-value pairs are
-//       represented as HeapObjects.
+//       has a unique object id (OID) and a fixed number of fields,
+//       laid out in the order the user-defined type declares them
+//       (its shape). Each field value is represented as a DataObject
+//       and is accessed by its offset within the shape, which the
+//       type checker computes for every path. The field arrays are
+//       represented as HeapObjects, which are read and updated in
+//       place through the pointer returned by get_obj. Objects that
+//       are no longer reachable are reclaimed by a mark-sweep garbage
+//       collector that the AST interpreter or the bytecode VM runs
+//       (marking from its own roots) once the heap grows past a
+//       threshold.
 //----------------------------------------------------------------------
 
 #ifndef HEAP_H
 #define HEAP_H
 
 #include <unordered_map>
+#include <vector>
+#include <string>
 #include "data_object.h"
 
 
@@ -23,35 +31,42 @@ class HeapObject
 public:
 
   //----------------------------------------------------------------------
-  // Add or update a given name with the given data object.
+  // Create an object with the given number of (nil) fields.
   // Inputs:
-  //   att -- the attribute (variable) name
-  //   obj -- the attribute (variable) value
+  //   field_count -- the number of fields in the object's shape
   //----------------------------------------------------------------------
-  void set_att(const std::string& att, const DataObject& obj);
+  HeapObject(size_t field_count = 0);
 
   //----------------------------------------------------------------------
-  // Check if the attribute exists in the heap object
+  // Update the given field with the given data object.
   // Inputs:
-  //   att -- the attribute (variable) to check
-  // Returns:
-  //   true if the attribute has been added, false otherwise
+  //   field -- the offset of the field (variable) in the shape
+  //   obj -- the field (variable) value
   //----------------------------------------------------------------------
-  bool has_att(const std::string& att) const;
+  void set_att(size_t field, const DataObject& obj);
 
   //----------------------------------------------------------------------
-  // Get the value of the given attribute
+  // Access the value of the given field in place (the offset is not
+  // checked)
   // Inputs:
-  //   att -- the attribute to get the value of
-  // Outputs:
-  //   obj -- the value of the object
+  //   field -- the offset of the field in the shape
   // Returns:
-  //   true if the heap object has the given attribute defined
+  //   the value of the field
+  //----------------------------------------------------------------------
+  DataObject& field(size_t field);
+  const DataObject& field(size_t field) const;
+
+  //----------------------------------------------------------------------
+  // Add the oids stored in the fields of the heap object
+  // Outputs:
+  //   oids -- the list to append the referenced oids to
   //----------------------------------------------------------------------
-  bool get_val(const std::string& att, DataObject& val);  
+  void add_oids(std::vector<size_t>& oids) const;
 
 private:
-  std::unordered_map<std::string,DataObject> attribute_values;
+  friend class Heap;
+  std::vector<DataObject> field_values;
+  bool marked = false;            // reachable in the current collection
 };
 
 
@@ -63,9 +78,9 @@ public:
   // Add or update the oid with the given heap object.
   // Inputs:
   //   oid -- the oid to add or update
-  //   obj -- the value of the oid
+  //   obj -- the value of the oid (moved into the heap)
   //----------------------------------------------------------------------
-  void set_obj(size_t oid, const HeapObject& obj);
+  void set_obj(size_t oid, HeapObject obj);
 
   //----------------------------------------------------------------------
   // Check if the oid is in the heap.
@@ -77,18 +92,61 @@ public:
   bool has_obj(size_t oid) const;
 
   //----------------------------------------------------------------------
-  // Get the user-defined type object associated with given oid.
+  // Get the user-defined type object associated with given oid. The
+  // object stays at the same address until it is collected, so its
+  // fields can be read and updated through the pointer.
   // Inputs:
   //   oid -- the oid to look up
-  // Outputs:
-  //   obj -- the heap object associated with the oid
   // Returns:
-  //   true if the oid is present in the heap, and false otherwise
+  //   the heap object associated with the oid, or nullptr if the oid
+  //   is not present in the heap
+  //----------------------------------------------------------------------
+  HeapObject* get_obj(size_t oid);
+
+  //----------------------------------------------------------------------
+  // Check if the heap has grown enough since the last collection that
+  // the garbage collector should run before the next allocation.
+  // Returns:
+  //   true if a collection is due, false otherwise
+  //----------------------------------------------------------------------
+  bool needs_collection() const;
+
+  //----------------------------------------------------------------------
+  // Mark the given root (if it is an oid) and every object reachable
+  // from it as live for the current collection.
+  // Inputs:
+  //   root -- a value held by the program (variable, temporary, etc.)
+  //----------------------------------------------------------------------
+  void mark(const DataObject& root);
+
+  //----------------------------------------------------------------------
+  // Free every object that was not marked since the last sweep and
+  // clear the marks of the others. All roots must be marked first.
+  // Returns:
+  //   the number of objects freed
+  //----------------------------------------------------------------------
+  size_t sweep();
+
+  //----------------------------------------------------------------------
+  // Give the garbage collection statistics for printing.
+  // Returns:
+  //   the number of collections, objects allocated and freed, and the
+  //   live and peak object counts
   //----------------------------------------------------------------------
-  bool get_obj(size_t oid, HeapObject& obj) const;
+  std::string stats() const;
 
 private:
   std::unordered_map<size_t, HeapObject> heap_objs;
+
+  // collect once this many objects are live (grows with the live set)
+  static const size_t MIN_THRESHOLD = 1024;
+  size_t threshold = MIN_THRESHOLD;
+
+  // collection statistics
+  size_t collections = 0;
+  size_t allocated = 0;
+  size_t freed = 0;
+  size_t peak = 0;
 };
 
 
@@ -96,22 +154,33 @@ private:
 // HeapObject Member Functions
 //----------------------------------------------------------------------
 
-void HeapObject::set_att(const std::string& att, const DataObject& obj)
+HeapObject::HeapObject(size_t field_count)
+  : field_values(field_count)
+{
+}
+
+void HeapObject::set_att(size_t field, const DataObject& obj)
+{
+  field_values[field] = obj;
+}
+
+DataObject& HeapObject::field(size_t field)
 {
-  attribute_values[att] = obj;
+  return field_values[field];
 }
 
-bool HeapObject::has_att(const std::string& att) const
+const DataObject& HeapObject::field(size_t field) const
 {
-  return attribute_values.count(att) > 0;
+  return field_values[field];
 }
 
-bool HeapObject::get_val(const std::string& att, DataObject& val)
+void HeapObject::add_oids(std::vector<size_t>& oids) const
 {
-  if (!has_att(att))
-    return false;
-  val = attribute_values.at(att);
-  return true;
+  for (const DataObject& val : field_values) {
+    size_t oid;
+    if (val.is_oid() and val.value(oid))
+      oids.push_back(oid);
+  }
 }
 
 
@@ -119,9 +188,14 @@ bool HeapObject::get_val(const std::string& att, DataObject& val)
 // Heap Member Functions
 //----------------------------------------------------------------------
 
-void Heap::set_obj(size_t oid, const HeapObject& obj)
+void Heap::set_obj(size_t oid, HeapObject obj)
 {
-  heap_objs[oid] = obj;
+  if (!has_obj(oid)) {
+    ++allocated;
+    if (heap_objs.size() + 1 > peak)
+      peak = heap_objs.size() + 1;
+  }
+  heap_objs[oid] = std::move(obj);
 }
 
 
@@ -131,12 +205,69 @@ bool Heap::has_obj(size_t oid) const
 }
 
 
-bool Heap::get_obj(size_t oid, HeapObject& obj) const
+HeapObject* Heap::get_obj(size_t oid)
+{
+  auto it = heap_objs.find(oid);
+  if (it == heap_objs.end())
+    return nullptr;
+  return &it->second;
+}
+
+
+bool Heap::needs_collection() const
+{
+  return heap_objs.size() >= threshold;
+}
+
+
+void Heap::mark(const DataObject& root)
+{
+  size_t oid;
+  if (!root.is_oid() or !root.value(oid))
+    return;
+  // depth-first over an explicit stack (long lists would overflow the
+  // call stack if marked recursively)
+  std::vector<size_t> pending = {oid};
+  while (!pending.empty()) {
+    auto it = heap_objs.find(pending.back());
+    pending.pop_back();
+    if (it == heap_objs.end() or it->second.marked)
+      continue;
+    it->second.marked = true;
+    it->second.add_oids(pending);
+  }
+}
+
+
+size_t Heap::sweep()
+{
+  size_t count = 0;
+  for (auto it = heap_objs.begin(); it != heap_objs.end(); ) {
+    if (it->second.marked) {
+      it->second.marked = false;
+      ++it;
+    }
+    else {
+      it = heap_objs.erase(it);
+      ++count;
+    }
+  }
+  ++collections;
+  freed += count;
+  // wait for the live set to double before collecting again
+  threshold = 2 * heap_objs.size();
+  if (threshold < MIN_THRESHOLD)
+    threshold = MIN_THRESHOLD;
+  return count;
+}
+
+
+std::string Heap::stats() const
 {
-  if (!has_obj(oid))
-    return false;
-  obj = heap_objs.at(oid);
-  return true;
+  return "gc: " + std::to_string(collections) + " collections, " +
+    std::to_string(allocated) + " allocated, " + std::to_string(freed) +
+    " freed, " + std::to_string(heap_objs.size()) + " live, " +
+    std::to_string(peak) + " peak";
 }
 
 
@@ -0,0 +1,928 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: inliner.h
+// DATE: Oct 16, 2026
+// DESC: Replaces calls of small non-recursive functions with copies
+//       of their bodies, after type checking and before variable
+//       resolution (so the copies are resolved where they end up).
+//
+//       A function whose body is a single return statement is inlined
+//       wherever it is called. Its parameters are replaced by the
+//       argument expressions. A literal or variable argument can be
+//       used any number of times. Any other argument is only
+//       substituted if it cannot fail or have side effects and the
+//       parameter is used at most once, so the program computes the
+//       same thing as before.
+//
+//       A function with no return statement that is called as a
+//       statement is inlined as a block, "if true then var p: t = arg
+//       ... body ... end". The block gives the parameters and the
+//       body's variables a scope of their own.
+//
+//       Only functions within the size budget (in AST nodes, counted
+//       after their own calls are inlined) are inlined. Functions are
+//       processed callees first, and recursion is found with Tarjan's
+//       strongly connected components.
+//----------------------------------------------------------------------
+
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "ast.h"
+
+
+// the default maximum size of an inlined function body (in nodes)
+const int DEFAULT_INLINE_BUDGET = 40;
+
+
+//----------------------------------------------------------------------
+// AST SCAN (what a subtree contains)
+//----------------------------------------------------------------------
+
+class AstScan : public Visitor
+{
+public:
+
+  int nodes = 0;                // nodes in the subtree
+  int returns = 0;              // return statements
+  int calls = 0;                // function calls (including built-ins)
+  int news = 0;                 // new objects
+  int unsafe_ops = 0;           // divisions and mods (which may fail)
+  int paths = 0;                // ids with fields (which may be nil)
+  // the number of uses of each variable, and of uses with a path
+  std::unordered_map<std::string, int> uses;
+  std::unordered_map<std::string, int> path_uses;
+
+  // true if the expression can neither fail nor have side effects
+  bool safe() const {
+    return calls == 0 and news == 0 and unsafe_ops == 0 and paths == 0;
+  }
+
+  // top-level
+  void visit(Program&) {}
+  void visit(FunDecl& node);
+  void visit(TypeDecl&) {}
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+private:
+  void stmts(Span<Stmt*>& stmt_list);
+};
+
+
+void AstScan::stmts(Span<Stmt*>& stmt_list)
+{
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+}
+
+
+void AstScan::visit(FunDecl& node)
+{
+  stmts(node.stmts);
+}
+
+
+void AstScan::visit(VarDeclStmt& node)
+{
+  ++nodes;
+  node.expr->accept(*this);
+}
+
+
+void AstScan::visit(AssignStmt& node)
+{
+  ++nodes;
+  node.expr->accept(*this);
+}
+
+
+void AstScan::visit(ReturnStmt& node)
+{
+  ++nodes;
+  ++returns;
+  node.expr->accept(*this);
+}
+
+
+void AstScan::visit(IfStmt& node)
+{
+  ++nodes;
+  node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* b : node.else_ifs) {
+    b->expr->accept(*this);
+    stmts(b->stmts);
+  }
+  stmts(node.body_stmts);
+}
+
+
+void AstScan::visit(WhileStmt& node)
+{
+  ++nodes;
+  node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+
+void AstScan::visit(ForStmt& node)
+{
+  ++nodes;
+  node.start->accept(*this);
+  node.end->accept(*this);
+  stmts(node.stmts);
+}
+
+
+void AstScan::visit(Expr& node)
+{
+  // walk the chain of left operands in a loop
+  Expr* e = &node;
+  while (true) {
+    ++nodes;
+    if (e->op and (e->op->type() == DIVIDE or e->op->type() == MODULO))
+      ++unsafe_ops;
+    if (e->rest)
+      e->rest->accept(*this);
+    Expr* left = e->left_expr();
+    if (!left)
+      break;
+    ++nodes;                    // the term holding the left operand
+    e = left;
+  }
+  e->first->accept(*this);
+}
+
+
+void AstScan::visit(SimpleTerm& node)
+{
+  ++nodes;
+  node.rvalue->accept(*this);
+}
+
+
+void AstScan::visit(ComplexTerm& node)
+{
+  ++nodes;
+  node.expr->accept(*this);
+}
+
+
+void AstScan::visit(SimpleRValue&)
+{
+  ++nodes;
+}
+
+
+void AstScan::visit(NewRValue&)
+{
+  ++nodes;
+  ++news;
+}
+
+
+void AstScan::visit(CallExpr& node)
+{
+  ++nodes;
+  ++calls;
+  for (Expr* e : node.arg_list)
+    e->accept(*this);
+}
+
+
+void AstScan::visit(IDRValue& node)
+{
+  ++nodes;
+  std::string name = node.path.front().lexeme();
+  ++uses[name];
+  if (node.path.size() > 1) {
+    ++paths;
+    ++path_uses[name];
+  }
+}
+
+
+void AstScan::visit(NegatedRValue& node)
+{
+  ++nodes;
+  node.expr->accept(*this);
+}
+
+
+//----------------------------------------------------------------------
+// AST CLONER (copies a subtree, optionally replacing parameters)
+//----------------------------------------------------------------------
+
+class AstCloner : public Visitor
+{
+public:
+
+  // copy into the given arena, replacing each use of a parameter by a
+  // copy of its argument (if there are any parameters)
+  AstCloner(Arena& arena,
+            const std::unordered_map<std::string, Expr*>* args = nullptr)
+    : arena(arena), args(args) {}
+
+  Expr* copy(Expr* node);
+  Stmt* copy(Stmt* node);
+
+  // top-level
+  void visit(Program&) {}
+  void visit(FunDecl&) {}
+  void visit(TypeDecl&) {}
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+private:
+
+  Arena& arena;
+  const std::unordered_map<std::string, Expr*>* args;
+
+  // the copy of the last node visited
+  Stmt* stmt_copy = nullptr;
+  Expr* expr_copy = nullptr;
+  ExprTerm* term_copy = nullptr;
+  RValue* rvalue_copy = nullptr;
+
+  template<typename T> Span<T> copy(const Span<T>& list);
+  Span<Stmt*> copy(const Span<Stmt*>& stmt_list);
+  Span<Expr*> copy(const Span<Expr*>& expr_list);
+  BasicIf* copy(BasicIf* node);
+  Token* copy(Token* token);
+  Expr* argument(const Token& id);
+};
+
+
+Expr* AstCloner::copy(Expr* node)
+{
+  if (!node)
+    return nullptr;
+  node->accept(*this);
+  return expr_copy;
+}
+
+
+Stmt* AstCloner::copy(Stmt* node)
+{
+  node->accept(*this);
+  return stmt_copy;
+}
+
+
+template<typename T>
+Span<T> AstCloner::copy(const Span<T>& list)
+{
+  Span<T> result = arena.fill(list.size(), T());
+  for (size_t i = 0; i < list.size(); ++i)
+    result[i] = list[i];
+  return result;
+}
+
+
+Span<Stmt*> AstCloner::copy(const Span<Stmt*>& stmt_list)
+{
+  Span<Stmt*> result = arena.fill(stmt_list.size(), (Stmt*)nullptr);
+  for (size_t i = 0; i < stmt_list.size(); ++i)
+    result[i] = copy(stmt_list[i]);
+  return result;
+}
+
+
+Span<Expr*> AstCloner::copy(const Span<Expr*>& expr_list)
+{
+  Span<Expr*> result = arena.fill(expr_list.size(), (Expr*)nullptr);
+  for (size_t i = 0; i < expr_list.size(); ++i)
+    result[i] = copy(expr_list[i]);
+  return result;
+}
+
+
+BasicIf* AstCloner::copy(BasicIf* node)
+{
+  BasicIf* b = arena.make<BasicIf>();
+  b->expr = copy(node->expr);
+  b->stmts = copy(node->stmts);
+  return b;
+}
+
+
+Token* AstCloner::copy(Token* token)
+{
+  return token ? arena.make<Token>(*token) : nullptr;
+}
+
+
+// the argument replacing the id (null if the id is not a parameter)
+Expr* AstCloner::argument(const Token& id)
+{
+  if (!args)
+    return nullptr;
+  auto it = args->find(id.lexeme());
+  return it == args->end() ? nullptr : it->second;
+}
+
+
+void AstCloner::visit(VarDeclStmt& node)
+{
+  VarDeclStmt* v = arena.make<VarDeclStmt>(node);
+  v->type = copy(node.type);
+  v->expr = copy(node.expr);
+  stmt_copy = v;
+}
+
+
+void AstCloner::visit(AssignStmt& node)
+{
+  AssignStmt* a = arena.make<AssignStmt>(node);
+  a->lvalue_list = copy(node.lvalue_list);
+  a->fields = copy(node.fields);
+  a->expr = copy(node.expr);
+  stmt_copy = a;
+}
+
+
+void AstCloner::visit(ReturnStmt& node)
+{
+  ReturnStmt* r = arena.make<ReturnStmt>();
+  r->expr = copy(node.expr);
+  stmt_copy = r;
+}
+
+
+void AstCloner::visit(IfStmt& node)
+{
+  IfStmt* i = arena.make<IfStmt>();
+  i->if_part = copy(node.if_part);
+  i->else_ifs = arena.fill(node.else_ifs.size(), (BasicIf*)nullptr);
+  for (size_t k = 0; k < node.else_ifs.size(); ++k)
+    i->else_ifs[k] = copy(node.else_ifs[k]);
+  i->body_stmts = copy(node.body_stmts);
+  stmt_copy = i;
+}
+
+
+void AstCloner::visit(WhileStmt& node)
+{
+  WhileStmt* w = arena.make<WhileStmt>();
+  w->expr = copy(node.expr);
+  w->stmts = copy(node.stmts);
+  stmt_copy = w;
+}
+
+
+void AstCloner::visit(ForStmt& node)
+{
+  ForStmt* f = arena.make<ForStmt>(node);
+  f->start = copy(node.start);
+  f->end = copy(node.end);
+  f->stmts = copy(node.stmts);
+  stmt_copy = f;
+}
+
+
+void AstCloner::visit(Expr& node)
+{
+  // copy the chain of left operands innermost first (in a loop)
+  std::vector<Expr*> chain;
+  for (Expr* e = &node; e != nullptr; e = e->left_expr())
+    chain.push_back(e);
+  Expr* result = nullptr;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    Expr* e = arena.make<Expr>(**it);
+    if (result) {
+      ComplexTerm* term = arena.make<ComplexTerm>();
+      term->expr = result;
+      e->first = term;
+    }
+    else {
+      (*it)->first->accept(*this);
+      e->first = term_copy;
+    }
+    e->op = copy((*it)->op);
+    e->rest = copy((*it)->rest);
+    result = e;
+  }
+  expr_copy = result;
+}
+
+
+void AstCloner::visit(SimpleTerm& node)
+{
+  // a parameter becomes (a copy of) its argument
+  IDRValue* id = dynamic_cast<IDRValue*>(node.rvalue);
+  Expr* arg = id and id->path.size() == 1 ? argument(id->path.front()) : nullptr;
+  if (arg) {
+    AstCloner arg_cloner(arena);
+    Expr* e = arg_cloner.copy(arg);
+    if (!e->negated and !e->op)
+      term_copy = e->first;
+    else {
+      ComplexTerm* term = arena.make<ComplexTerm>();
+      term->expr = e;
+      term_copy = term;
+    }
+    return;
+  }
+  SimpleTerm* s = arena.make<SimpleTerm>();
+  node.rvalue->accept(*this);
+  s->rvalue = rvalue_copy;
+  term_copy = s;
+}
+
+
+void AstCloner::visit(ComplexTerm& node)
+{
+  ComplexTerm* c = arena.make<ComplexTerm>();
+  c->expr = copy(node.expr);
+  term_copy = c;
+}
+
+
+void AstCloner::visit(SimpleRValue& node)
+{
+  rvalue_copy = arena.make<SimpleRValue>(node);
+}
+
+
+void AstCloner::visit(NewRValue& node)
+{
+  rvalue_copy = arena.make<NewRValue>(node);
+}
+
+
+void AstCloner::visit(CallExpr& node)
+{
+  CallExpr* c = arena.make<CallExpr>();
+  c->function_id = node.function_id;
+  c->arg_list = copy(node.arg_list);
+  rvalue_copy = c;
+  stmt_copy = c;
+}
+
+
+void AstCloner::visit(IDRValue& node)
+{
+  IDRValue* i = arena.make<IDRValue>(node);
+  i->path = copy(node.path);
+  i->fields = copy(node.fields);
+  // a parameter's fields are read through the argument variable
+  Expr* arg = argument(node.path.front());
+  if (arg) {
+    SimpleTerm* term = static_cast<SimpleTerm*>(arg->first);
+    i->path[0] = static_cast<IDRValue*>(term->rvalue)->path.front();
+  }
+  rvalue_copy = i;
+}
+
+
+void AstCloner::visit(NegatedRValue& node)
+{
+  NegatedRValue* n = arena.make<NegatedRValue>();
+  n->expr = copy(node.expr);
+  rvalue_copy = n;
+}
+
+
+//----------------------------------------------------------------------
+// INLINER
+//----------------------------------------------------------------------
+
+class Inliner : public Visitor
+{
+public:
+
+  // inline function bodies of up to budget nodes
+  Inliner(int budget = DEFAULT_INLINE_BUDGET) : budget(budget) {}
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+  // the number of calls replaced by function bodies
+  int inlined() const {return inline_count;}
+
+private:
+
+  // what is known about each function
+  struct FunInfo
+  {
+    FunDecl* decl = nullptr;
+    std::vector<int> callees;   // the user functions it calls
+    bool recursive = false;     // calls itself (possibly indirectly)
+    bool expr_body = false;     // inline it into expressions
+    bool block_body = false;    // inline it into statement lists
+    AstScan scan;               // its body (after its own inlining)
+  };
+
+  int budget;
+  Arena* arena = nullptr;
+  std::vector<FunInfo> funs;
+  std::unordered_map<std::string, int> fun_index;
+
+  // true during the first pass (which only finds the calls), and the
+  // function being visited
+  bool collecting = false;
+  int curr_fun = -1;
+
+  int inline_count = 0;
+
+  // helpers
+  int user_function(const std::string& name);
+  std::vector<int> callees_first();
+  void classify(FunInfo& info);
+  ExprTerm* inline_call(ExprTerm* term);
+  Stmt* inline_block(Stmt* stmt);
+  void stmts(Span<Stmt*>& stmt_list);
+};
+
+
+// the index of the named user function (-1 for a built-in, which is
+// called even if a function of the same name is declared)
+int Inliner::user_function(const std::string& name)
+{
+  static const std::unordered_set<std::string> BUILT_INS = {
+    "print", "stoi", "stod", "itos", "dtos", "get", "length", "read", "flush"
+  };
+  auto it = fun_index.find(name);
+  if (it == fun_index.end() or BUILT_INS.count(name))
+    return -1;
+  return it->second;
+}
+
+
+// every function, with callees before their callers (Tarjan's strongly
+// connected components, done with an explicit stack since call chains
+// can be long), marking the recursive ones
+std::vector<int> Inliner::callees_first()
+{
+  int count = funs.size();
+  std::vector<int> index(count, -1), low(count, 0), order, stack;
+  std::vector<bool> on_stack(count, false);
+  std::vector<std::pair<int, size_t>> work;    // function, next callee
+  int next_index = 0;
+  for (int root = 0; root < count; ++root) {
+    if (index[root] != -1)
+      continue;
+    work.push_back({root, 0});
+    while (!work.empty()) {
+      int v = work.back().first;
+      if (index[v] == -1) {
+        index[v] = low[v] = next_index++;
+        stack.push_back(v);
+        on_stack[v] = true;
+      }
+      if (work.back().second < funs[v].callees.size()) {
+        int w = funs[v].callees[work.back().second++];
+        if (index[w] == -1)
+          work.push_back({w, 0});
+        else if (on_stack[w])
+          low[v] = std::min(low[v], index[w]);
+        continue;
+      }
+      if (low[v] == index[v]) {
+        // v and everything above it on the stack call each other
+        size_t start = std::find(stack.begin(), stack.end(), v) - stack.begin();
+        bool cycle = stack.size() - start > 1 or
+          std::count(funs[v].callees.begin(), funs[v].callees.end(), v);
+        for (size_t i = start; i < stack.size(); ++i) {
+          on_stack[stack[i]] = false;
+          funs[stack[i]].recursive = cycle;
+          order.push_back(stack[i]);
+        }
+        stack.resize(start);
+      }
+      work.pop_back();
+      if (!work.empty()) {
+        int u = work.back().first;
+        low[u] = std::min(low[u], low[v]);
+      }
+    }
+  }
+  return order;
+}
+
+
+// decide how (if at all) the function can be inlined
+void Inliner::classify(FunInfo& info)
+{
+  FunDecl& f = *info.decl;
+  f.accept(info.scan);
+  if (info.recursive or budget <= 0 or info.scan.nodes > budget)
+    return;
+  info.expr_body = f.stmts.size() == 1 and dynamic_cast<ReturnStmt*>(f.stmts[0]);
+  info.block_body = info.scan.returns == 0;
+}
+
+
+// the body of the called function if the term is a call that can be
+// inlined, else the term itself
+ExprTerm* Inliner::inline_call(ExprTerm* term)
+{
+  SimpleTerm* simple = dynamic_cast<SimpleTerm*>(term);
+  CallExpr* call = simple ? dynamic_cast<CallExpr*>(simple->rvalue) : nullptr;
+  int index = call ? user_function(call->function_id.lexeme()) : -1;
+  if (index < 0 or !funs[index].expr_body)
+    return term;
+  FunInfo& info = funs[index];
+  FunDecl& f = *info.decl;
+  // every argument must be safe to substitute for its parameter
+  std::unordered_map<std::string, Expr*> args;
+  for (size_t i = 0; i < f.params.size(); ++i) {
+    std::string name = f.params[i].id.lexeme();
+    Expr* arg = call->arg_list[i];
+    SimpleTerm* arg_term = dynamic_cast<SimpleTerm*>(arg->first);
+    bool single = !arg->negated and !arg->op and arg_term;
+    bool literal = single and dynamic_cast<SimpleRValue*>(arg_term->rvalue);
+    IDRValue* id = single ? dynamic_cast<IDRValue*>(arg_term->rvalue) : nullptr;
+    bool variable = id and id->path.size() == 1;
+    int uses = info.scan.uses[name];
+    if (!variable and info.scan.path_uses[name] > 0)
+      return term;
+    if (!literal and !variable) {
+      AstScan arg_scan;
+      arg->accept(arg_scan);
+      if (!arg_scan.safe() or uses > 1)
+        return term;
+    }
+    args[name] = arg;
+  }
+  AstCloner cloner(*arena, &args);
+  ComplexTerm* body = arena->make<ComplexTerm>();
+  body->expr = cloner.copy(static_cast<ReturnStmt*>(f.stmts[0])->expr);
+  ++inline_count;
+  return body;
+}
+
+
+// the called function's body as a block if the statement is a call
+// that can be inlined, else the statement itself
+Stmt* Inliner::inline_block(Stmt* stmt)
+{
+  CallExpr* call = dynamic_cast<CallExpr*>(stmt);
+  int index = call ? user_function(call->function_id.lexeme()) : -1;
+  if (index < 0 or !funs[index].block_body)
+    return stmt;
+  FunDecl& f = *funs[index].decl;
+  // the arguments are evaluated inside the block, so they must not
+  // refer to a variable a parameter would hide
+  AstScan arg_scan;
+  for (Expr* arg : call->arg_list)
+    arg->accept(arg_scan);
+  for (FunDecl::FunParam& param : f.params)
+    if (arg_scan.uses.count(param.id.lexeme()))
+      return stmt;
+  // if true then var p1: t1 = arg1 ... body ... end
+  Token at = call->function_id;
+  SimpleRValue* true_val = arena->make<SimpleRValue>();
+  true_val->value = Token(BOOL_VAL, "true", 4, at.line(), at.column());
+  SimpleTerm* true_term = arena->make<SimpleTerm>();
+  true_term->rvalue = true_val;
+  BasicIf* block = arena->make<BasicIf>();
+  block->expr = arena->make<Expr>();
+  block->expr->first = true_term;
+  block->stmts = arena->fill(f.params.size() + f.stmts.size(), (Stmt*)nullptr);
+  for (size_t i = 0; i < f.params.size(); ++i) {
+    VarDeclStmt* param = arena->make<VarDeclStmt>();
+    param->type = arena->make<Token>(f.params[i].type);
+    param->id = f.params[i].id;
+    param->expr = call->arg_list[i];
+    block->stmts[i] = param;
+  }
+  AstCloner cloner(*arena);
+  for (size_t i = 0; i < f.stmts.size(); ++i)
+    block->stmts[f.params.size() + i] = cloner.copy(f.stmts[i]);
+  IfStmt* if_stmt = arena->make<IfStmt>();
+  if_stmt->if_part = block;
+  ++inline_count;
+  return if_stmt;
+}
+
+
+void Inliner::stmts(Span<Stmt*>& stmt_list)
+{
+  for (Stmt*& s : stmt_list) {
+    s->accept(*this);
+    if (!collecting)
+      s = inline_block(s);
+  }
+}
+
+
+//----------------------------------------------------------------------
+// TOP-LEVEL
+//----------------------------------------------------------------------
+
+void Inliner::visit(Program& node)
+{
+  arena = &node.arena;
+  for (Decl* d : node.decls) {
+    FunDecl* f = dynamic_cast<FunDecl*>(d);
+    if (f and !fun_index.count(f->id.lexeme())) {
+      fun_index[f->id.lexeme()] = funs.size();
+      funs.push_back(FunInfo());
+      funs.back().decl = f;
+    }
+  }
+  // find the calls, then inline callees first so that a function is
+  // measured (and copied) with its own calls already inlined
+  collecting = true;
+  for (size_t i = 0; i < funs.size(); ++i) {
+    curr_fun = i;
+    funs[i].decl->accept(*this);
+  }
+  collecting = false;
+  for (int i : callees_first()) {
+    curr_fun = i;
+    funs[i].decl->accept(*this);
+    classify(funs[i]);
+  }
+  for (Decl* d : node.decls)
+    if (dynamic_cast<TypeDecl*>(d))
+      d->accept(*this);
+}
+
+
+void Inliner::visit(FunDecl& node)
+{
+  stmts(node.stmts);
+}
+
+
+void Inliner::visit(TypeDecl& node)
+{
+  for (VarDeclStmt* v : node.vdecls)
+    v->accept(*this);
+}
+
+
+//----------------------------------------------------------------------
+// STATEMENTS
+//----------------------------------------------------------------------
+
+void Inliner::visit(VarDeclStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Inliner::visit(AssignStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Inliner::visit(ReturnStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Inliner::visit(IfStmt& node)
+{
+  node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* b : node.else_ifs) {
+    b->expr->accept(*this);
+    stmts(b->stmts);
+  }
+  stmts(node.body_stmts);
+}
+
+
+void Inliner::visit(WhileStmt& node)
+{
+  node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+
+void Inliner::visit(ForStmt& node)
+{
+  node.start->accept(*this);
+  node.end->accept(*this);
+  stmts(node.stmts);
+}
+
+
+//----------------------------------------------------------------------
+// EXPRESSIONS
+//----------------------------------------------------------------------
+
+void Inliner::visit(Expr& node)
+{
+  // walk the chain of left operands in a loop (only the innermost
+  // first term can be a call)
+  Expr* e = &node;
+  while (Expr* left = e->left_expr()) {
+    e->rest->accept(*this);
+    e = left;
+  }
+  e->first->accept(*this);
+  if (!collecting)
+    e->first = inline_call(e->first);
+  if (e->rest)
+    e->rest->accept(*this);
+}
+
+
+void Inliner::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+}
+
+
+void Inliner::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Inliner::visit(SimpleRValue&)
+{
+}
+
+
+void Inliner::visit(NewRValue&)
+{
+}
+
+
+void Inliner::visit(CallExpr& node)
+{
+  for (Expr* e : node.arg_list)
+    e->accept(*this);
+  if (collecting) {
+    int index = user_function(node.function_id.lexeme());
+    if (index >= 0)
+      funs[curr_fun].callees.push_back(index);
+  }
+}
+
+
+void Inliner::visit(IDRValue&)
+{
+}
+
+
+void Inliner::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+}
+
+
+#endif
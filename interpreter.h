@@ -14,17 +14,21 @@
 #include <iostream>
 #include <algorithm>
 #include <unordered_map>
-#include <regex>
+#include <vector>
+#include <list>
 #include "ast.h"
-#include "symbol_table.h"
 #include "data_object.h"
 #include "heap.h"
+#include "output.h"
 
 
 class Interpreter : public Visitor
 {
 public:
 
+// create an interpreter (optionally without the debugger prompt)
+Interpreter(bool prompt_debugger = true) : prompt_debugger(prompt_debugger) {}
+
 // top-level
 void visit(Program& node);
 void visit(FunDecl& node);
@@ -50,23 +54,46 @@ void visit(NegatedRValue& node);
 // return code from calling main
 int return_code() const;
 
+// garbage collection statistics
+std::string gc_stats() const;
+
 
 private:
 
-// return exception
-class MyPLReturnException : public std::exception {};
+// set by a return statement, telling enclosing statement lists and
+// loops to stop executing until the function call completes
+bool returning = false;
+
+// set by a call in tail position to the function the current call
+// continues with (its arguments are the last values in temp_roots)
+FunDecl* tail_fun = nullptr;
+
+// variable values of every open scope, in declaration order, where
+// scope_base holds the index of each scope's first variable (the
+// resolver gives each variable its scope depth and slot)
+std::vector<DataObject> frame;
+std::vector<size_t> scope_base;
 
-// the symbol table 
-SymbolTable sym_table;
+// values held outside of the frame that must survive a garbage
+// collection (call arguments and the owner of an assigned field)
+std::vector<DataObject> temp_roots;
 
 // holds the previously computed value
 DataObject curr_val;
 
+// the binary expressions being evaluated (a chain of left operands is
+// walked with this stack instead of recursion)
+std::vector<Expr*> expr_chain;
+
 // the heap
 Heap heap;
 
+// program output (written by print, flushed at the end and before reads)
+Output output;
+
 // debugging activation
-bool debug;//global control over debugger
+bool prompt_debugger;//ask whether to debug when the program starts
+bool debug = false;//global control over debugger
 bool step_rng;//keep on printing as long as this is true. 
 size_t curr_step = 1;
 bool step_to_end = false;
@@ -81,9 +108,6 @@ std::unordered_map<std::string,FunDecl*> functions;
 // the user-defined types (all within the global environment)
 std::unordered_map<std::string,TypeDecl*> types;
 
-// the global environment id
-int global_env_id = 0;
-
 // the program return code
 int ret_code = 0;
 
@@ -91,6 +115,18 @@ int ret_code = 0;
 void error(const std::string& msg, const Token& token);
 void error(const std::string& msg); 
 
+// apply the operator of a binary expression
+void binary_op(Expr& node, DataObject& lhs_val, DataObject& rhs_val);
+
+// frame helpers
+void push_scope();
+void pop_scope();
+void bind_params(FunDecl* fun_node, size_t first_arg);
+DataObject& var_val(const VarSlot& var);
+
+// free the heap objects the program can no longer reach
+void collect_garbage();
+
 // debugger helpers
 void init_debugger();
 bool step_debugger();
@@ -104,6 +140,11 @@ int Interpreter::return_code() const
 	return ret_code;
 }
 
+std::string Interpreter::gc_stats() const
+{
+	return heap.stats();
+}
+
 void Interpreter::error(const std::string& msg, const Token& token)
 {
 	throw MyPLException(RUNTIME, msg, token.line(), token.column());
@@ -116,18 +157,66 @@ void Interpreter::error(const std::string& msg)
 }
 
 
+//open a new scope at the end of the frame
+void Interpreter::push_scope()
+{
+	scope_base.push_back(frame.size());
+}
+
+
+//drop the variables of the innermost scope
+void Interpreter::pop_scope()
+{
+	frame.resize(scope_base.back());
+	scope_base.pop_back();
+}
+
+
+//parameters take the first slots of the function's scope (the
+//arguments are the values from first_arg on in temp_roots)
+void Interpreter::bind_params(FunDecl* fun_node, size_t first_arg)
+{
+	frame.insert(frame.end(), temp_roots.begin() + first_arg,
+		temp_roots.begin() + first_arg + fun_node->params.size());
+	temp_roots.resize(first_arg);
+}
+
+
+//the value of a resolved variable (invalidated by the next declaration)
+DataObject& Interpreter::var_val(const VarSlot& var)
+{
+	return frame[scope_base[scope_base.size() - 1 - var.depth] + var.slot];
+}
+
+
+//mark everything reachable from the variables and temporaries, then
+//sweep the rest (an operand held by an expression is not a root since
+//objects are only compared by oid and oids are never reused)
+void Interpreter::collect_garbage()
+{
+	for(const DataObject& val : frame)
+		heap.mark(val);
+	for(const DataObject& val : temp_roots)
+		heap.mark(val);
+	heap.mark(curr_val);
+	heap.sweep();
+}
+
+
 // top-level
 void Interpreter::visit(Program& node)
 {
 
 	//Push Global Environment
-	sym_table.push_environment();
-
-	//Store the global environment id
-	global_env_id = sym_table.get_environment_id();
+	push_scope();
 
 	//start debugger
-	init_debugger();	
+	if(prompt_debugger)
+		init_debugger();	
+
+	//keep program output in step with the debugger's
+	if(debug)
+		output.set_mode(Output::UNBUFFERED);
 
 	//Add functions and UDTs
 	for(Decl* d : node.decls)
@@ -139,25 +228,21 @@ void Interpreter::visit(Program& node)
 	expr.accept(*this);
 
 	//pop the global environment
-	sym_table.pop_environment();
-	std::cout << "" << std::endl;//for aesthetic purposes
+	pop_scope();
+	output.write('\n');//for aesthetic purposes
+	output.flush();
 }
 
 //Function declaration
 void Interpreter::visit(FunDecl& node)
 {
-	FunDecl* f = new FunDecl(); //just create the new function decl to get function id
-	*f = node;
-	functions.insert({node.id.lexeme(), f});
+	functions.insert({node.id.lexeme(), &node});//nodes live as long as the program
 }
 
 //UDT Declaration
 void Interpreter::visit(TypeDecl& node)
 {
-	//create a new Type decl for the name
-	TypeDecl* t = new TypeDecl();
-	*t = node;
-	types.insert({node.id.lexeme(), t});
+	types.insert({node.id.lexeme(), &node});
 }
 
 // statements
@@ -165,8 +250,7 @@ void Interpreter::visit(VarDeclStmt& node)
 {
 	node.expr->accept(*this);//traverse to expression of vdcl
 	std::string var_name = node.id.lexeme();
-	sym_table.add_name(var_name);//add name
-	sym_table.set_val_info(var_name, curr_val);//add type to var name
+	frame.push_back(curr_val);//declared variables take the next slot
 	
 	//NOTE step check debugging
 	if(step_debugger())
@@ -185,9 +269,8 @@ void Interpreter::visit(AssignStmt& node)
 	//Go through path
 	int path_num = 1;
 	DataObject tmp_dat;
-	HeapObject tmp_obj;
+	HeapObject* tmp_obj = nullptr;//updated in place
 	size_t tmp_oid;
-	size_t root_oid;
 	
 	//NOTE get the path as a string for later
 	std::string path_id = "";
@@ -210,7 +293,7 @@ void Interpreter::visit(AssignStmt& node)
 			Expr* e = node.expr;
 			e->accept(*this);
 			//set the current value to 
-			sym_table.set_val_info(root_id, curr_val);
+			var_val(node.var) = curr_val;
 				
 			//NOTE step check debugging
 			if(step_debugger())
@@ -227,10 +310,9 @@ void Interpreter::visit(AssignStmt& node)
 			
 			if(path_num == 1)//For first value
 			{
-				sym_table.get_val_info(t.lexeme(), tmp_dat);//get the value with the current id name and put it in tmp data object (this should hold an oid)
-				tmp_dat.value(tmp_oid);//put the oid from tmp_dat into tmp_oid
-				heap.get_obj(tmp_oid, tmp_obj);//get the heap object that has the current id of tmp_oid
-				root_oid = tmp_oid;
+				tmp_dat = var_val(node.var);//get the value of the first id (this should hold an oid)
+				if(!tmp_dat.value(tmp_oid) || !(tmp_obj = heap.get_obj(tmp_oid)))//get the heap object that has the current id of tmp_oid
+					error("attempt to access a field of a nil value");
 				
 				//NOTE setup lhs path print
 				step_rng = step_debugger();
@@ -245,13 +327,13 @@ void Interpreter::visit(AssignStmt& node)
 			}	
 			else//For general cases
 			{
-				tmp_obj.get_val(t.lexeme(), tmp_dat);//set value to attribute or last oid
+				int field = node.fields[path_num - 2];//offset of the id in the object's shape
 				if(path_num != node.lvalue_list.size())//if we aren't on the final element
 				{
+					tmp_dat = tmp_obj->field(field);//set value to attribute or last oid
 					//set the current oid value to one stored in curr_val
-					tmp_dat.value(tmp_oid);
-					//tmp_dat.value(tmp_oid);//get the oid
-					heap.get_obj(tmp_oid, tmp_obj);//get heap object i.e. udt
+					if(!tmp_dat.value(tmp_oid) || !(tmp_obj = heap.get_obj(tmp_oid)))//get heap object i.e. udt
+						error("attempt to access a field of a nil value");
 					
 					//NOTE for the normal 
 					if(step_rng)
@@ -265,11 +347,11 @@ void Interpreter::visit(AssignStmt& node)
 				else//if we are on the final element
 				{
 					Expr* e = node.expr;
+					temp_roots.push_back(DataObject(tmp_oid));//keep the owner alive
 					e->accept(*this);
-					//set the current value to 
-					tmp_dat = curr_val;
-					tmp_obj.set_att(t.lexeme(), tmp_dat);
-					heap.set_obj(root_oid, tmp_obj);		
+					temp_roots.pop_back();
+					//set the field of the object that owns the attribute
+					tmp_obj->field(field) = curr_val;
 					
 					//NOTE for the normal 
 					if(step_rng)
@@ -294,16 +376,16 @@ void Interpreter::visit(ReturnStmt& node)
 	//evaluate expression
 	node.expr->accept(*this);
 	
-	//NOTE step check debugging
-	if(step_debugger())
+	//NOTE step check debugging (a tail call has no value yet)
+	if(!tail_fun and step_debugger())
 	{
 		std::cout << "  |#" << curr_step << "| [Return Value->" + curr_val.to_string() + 
 		"][Type->" + curr_val.to_string_type()+ "]" << std::endl;
 		++curr_step;
 	}
 	
-	//throw the return exception
-	throw new MyPLReturnException;
+	//signal the return (curr_val holds the return value)
+	returning = true;
 }
 
 //If Statements
@@ -335,10 +417,14 @@ void Interpreter::visit(IfStmt& node)
 	if(if_param_val == true)//if the expression is true, loop
 	{
 		//body statements 
-		sym_table.push_environment();
+		push_scope();
 		for(Stmt* s : node.if_part->stmts)
-		s->accept(*this);
-		sym_table.pop_environment();		
+		{
+			s->accept(*this);
+			if(returning)
+				break;
+		}
+		pop_scope();		
 	}
 	else//if the if statement didn't catch 
 	{
@@ -367,10 +453,14 @@ void Interpreter::visit(IfStmt& node)
 				if(elseif_val == true)//if the exp is true, enter if	
 				{
 					//body statements
-					sym_table.push_environment();
+					push_scope();
 					for(Stmt* s : b->stmts)
+					{
 						s->accept(*this);
-					sym_table.pop_environment();					
+						if(returning)
+							break;
+					}
+					pop_scope();					
 				}
 			}
 		}
@@ -387,10 +477,14 @@ void Interpreter::visit(IfStmt& node)
 					}
 			
 				//body statements
-				sym_table.push_environment();
+				push_scope();
 				for(Stmt* st : node.body_stmts)
+				{
 					st->accept(*this);
-				sym_table.pop_environment();
+					if(returning)
+						break;
+				}
+				pop_scope();
 			}
 		}
 	}
@@ -418,10 +512,16 @@ void Interpreter::visit(WhileStmt& node)
 		if(condt == true)
 		{
 			//body statements
-			sym_table.push_environment();
+			push_scope();
 			for(Stmt* s : node.stmts)
+			{
 				s->accept(*this);
-			sym_table.pop_environment();
+				if(returning)
+					break;
+			}
+			pop_scope();
+			if(returning)//leave the loop on return
+				break;
 		}
 		else //exit case
 			condt = false;
@@ -430,19 +530,16 @@ void Interpreter::visit(WhileStmt& node)
 void Interpreter::visit(ForStmt& node)
 {
 
-	sym_table.push_environment();//push
+	push_scope();//push
 
 	//for loop conditions
 	Expr* e = node.start;
 	e->accept(*this);
 
 	//add for loop parameter variable to symbol table
-	std::string index_name = node.var_id.lexeme();
-	DataObject index_val = curr_val;
-	sym_table.add_name(index_name);
-	sym_table.set_val_info(index_name, index_val);//add type to var name
+	frame.push_back(curr_val);//loop variable takes the next slot
 	int start_i;
-	index_val.value(start_i);//set index val
+	curr_val.value(start_i);//set index val
 
 	//end loop condition
 	Expr* n = node.end;
@@ -460,301 +557,340 @@ void Interpreter::visit(ForStmt& node)
 	//body statements
 	for(int i = start_i; i <= end_i; ++i)
 	{
-		index_val.set(i);
-		sym_table.set_val_info(index_name, index_val);//add type to var name
-		sym_table.push_environment();			
+		var_val(node.var).set(i);//update the loop variable in place
+		push_scope();			
 		for(Stmt* st : node.stmts)
+		{
 			st->accept(*this);
-		sym_table.pop_environment();//pop body			
+			if(returning)
+				break;
+		}
+		pop_scope();//pop body			
+		if(returning)//leave the loop on return
+			break;
 	}
-	sym_table.pop_environment();//pop loop parameter
+	pop_scope();//pop loop parameter
 }
 
 //expressions
 void Interpreter::visit(Expr& node)
 {
-	//for negated values
-	if(node.negated == true)
+	//collect the chain of left operands (innermost last)
+	size_t base = expr_chain.size();
+	Expr* e = &node;
+	expr_chain.push_back(e);
+	while((e = e->left_expr()) != nullptr)
+		expr_chain.push_back(e);
+
+	//get the first value of the innermost expression
+	expr_chain.back()->first->accept(*this);
+
+	//then apply each operator (innermost first) to the value so far
+	while(expr_chain.size() > base)
 	{
-		node.first->accept(*this);
-		bool val;
-		curr_val.value(val);//copy curr val into val
-		curr_val.set(!val);//set curr val as not val
+		Expr* next = expr_chain.back();
+		expr_chain.pop_back();
+		if(next->negated == true)//for negated values
+		{
+			bool val;
+			curr_val.value(val);//copy curr val into val
+			curr_val.set(!val);//set curr val as not val
+		}
+		else if(next->op != nullptr)
+		{
+			//get a copy of the lhs value and get the rhs value
+			DataObject lhs_val = std::move(curr_val);
+			next->rest->accept(*this);
+			DataObject rhs_val = std::move(curr_val);
+			binary_op(*next, lhs_val, rhs_val);
+		}
 	}
-	else//for all other cases
+}
+
+//Binary operator: sets curr val to lhs [op] rhs
+void Interpreter::binary_op(Expr& node, DataObject& lhs_val, DataObject& rhs_val)
+{
+	TokenType op = node.op->type();
+
+	//Cases:
+	if(op == PLUS)// x + x
 	{
-		node.first->accept(*this);//get first value
-		if(node.op != nullptr)
+		//Integer addition
+		if(lhs_val.is_integer() && rhs_val.is_integer())// 1 + 2
+		{
+			int l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			curr_val.set(l+r);
+		}
+		//double addition
+		else if(lhs_val.is_double() && rhs_val.is_double())// 1.23 + 23.2
+		{
+			double l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			curr_val.set(l+r);
+		}
+		//Char/string concatination
+		else//x + y where either is 
 		{
-			//get a copy of the lhs value and get the rhs value
-			DataObject lhs_val = curr_val;
-			node.rest->accept(*this);
-			DataObject rhs_val = curr_val;
-			TokenType op = node.op->type();
 
-			//Cases:
-			if(op == PLUS)// x + x
+			if(lhs_val.is_char() && rhs_val.is_char()) // C + C
 			{
-				//Integer addition
-				if(lhs_val.is_integer() && rhs_val.is_integer())// 1 + 2
-				{
-					int l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					curr_val.set(l+r);
-				}
-				//double addition
-				else if(lhs_val.is_double() && rhs_val.is_double())// 1.23 + 23.2
-				{
-					double l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					curr_val.set(l+r);
-				}
-				//Char/string concatination
-				else//x + y where either is 
-				{
-
-					if(lhs_val.is_char() && rhs_val.is_char()) // C + C
-					{
-						char l, r;
-						lhs_val.value(l);//get l's value
-						rhs_val.value(r);//get r's value
-						std::string out = std::string() + l + r;
-						curr_val.set(out);
-					}
-					else if(lhs_val.is_char() && rhs_val.is_string()) // C + S
-					{
-						char l;
-						std::string r;
-						lhs_val.value(l);//get l's value
-						rhs_val.value(r);//get r's value
-						std::string out(1, l);
-						out += r;
-						curr_val.set(out);
-					}
-					else if(lhs_val.is_string() && rhs_val.is_char()) // S + C
-					{
-						char r;
-						std::string l;
-						lhs_val.value(l);//get l's value
-						rhs_val.value(r);//get r's value
-						std::string out(1, r);
-						l += out;
-						curr_val.set(l);
-					}
-					else if(lhs_val.is_string() && rhs_val.is_string())// S + S
-					{
-						std::string l, r;
-						lhs_val.value(l);
-						rhs_val.value(r);
-						l += r;
-						curr_val.set(l);
-					}
-					else
-					{
-						error("unable to add expressions provided");
-					}
-				}
+				char l, r;
+				lhs_val.value(l);//get l's value
+				rhs_val.value(r);//get r's value
+				std::string out = std::string() + l + r;
+				curr_val.set(out);
 			}
-			//More math operators
-			else if(op == MINUS || (op == MULTIPLY || op == DIVIDE))
+			else if(lhs_val.is_char() && rhs_val.is_string()) // C + S
 			{
-				if(lhs_val.is_integer() && rhs_val.is_integer())
-				{
-					int l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == MINUS)
-						curr_val.set(l-r);
-					else if(op == MULTIPLY)
-						curr_val.set(l*r);
-					else
-						curr_val.set(l/r);
-				}
-				else if(lhs_val.is_double() && rhs_val.is_double())
-				{
-				double l, r;//init variables
+				char l;
+				std::string r;
 				lhs_val.value(l);//get l's value
 				rhs_val.value(r);//get r's value
-				if(op == MINUS)
-					curr_val.set(l-r);
-				else if(op == MULTIPLY)
-					curr_val.set(l*r);
-				else
-					curr_val.set(l/r);
-				}
-				else
-					error("Simple Arithmetic Error");
+				std::string out(1, l);
+				out += r;
+				curr_val.set(out);
 			}
-			//Comparison Operators
-			else if(op == GREATER || op == GREATER_EQUAL || op == LESS || op == LESS_EQUAL)
+			else if(lhs_val.is_string() && rhs_val.is_char()) // S + C
 			{
-				if(lhs_val.is_integer() && rhs_val.is_integer())
-				{
-					int l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == GREATER)
-					{
-						curr_val.set(l>r);
-					}
-					else if(op == GREATER_EQUAL)
-						curr_val.set(l>=r);
-					else if(op == LESS)
-						curr_val.set(l<r);
-					else
-						curr_val.set(l<=r);
-				}
-				else if(lhs_val.is_double() && rhs_val.is_double())//X1 >=,<=,<,> X2 Double
-				{
-					double l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == GREATER)
-						curr_val.set(l>r);
-					else if(op == GREATER_EQUAL)
-						curr_val.set(l>=r);
-					else if(op == LESS)
-						curr_val.set(l<r);
-					else
-						curr_val.set(l<=r);
-				}
-				else if(lhs_val.is_char() && rhs_val.is_char())//X1 >=,<=,<,> X2 Char
-				{
-					char l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == GREATER)
-						curr_val.set(l>r);
-					else if(op == GREATER_EQUAL)
-						curr_val.set(l>=r);
-					else if(op == LESS)
-						curr_val.set(l<r);
-					else
-						curr_val.set(l<=r);
-				}
-				else if(lhs_val.is_string() && rhs_val.is_string())//String1 >=,<=,<,> String2
-				{
-					std::string l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value	
-					if(op == GREATER)
-						curr_val.set(l>r);
-					else if(op == GREATER_EQUAL)
-						curr_val.set(l>=r);
-					else if(op == LESS)
-						curr_val.set(l<r);
-					else
-						curr_val.set(l<=r);				  
-				}
-				else if(lhs_val.is_bool() && rhs_val.is_bool()) //Bool1 >=,<=,<,> Bool2
-				{
-					bool l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == GREATER)
-						curr_val.set(l>r);
-					else if(op == GREATER_EQUAL)
-						curr_val.set(l>=r);
-					else if(op == LESS)
-						curr_val.set(l<r);
-					else
-						curr_val.set(l<=r);
-				}
-				else
-					error("Unable to compute comparison operation");
+				char r;
+				std::string l;
+				lhs_val.value(l);//get l's value
+				rhs_val.value(r);//get r's value
+				std::string out(1, r);
+				l += out;
+				curr_val.set(l);
 			}
-			//MOD operator
-			else if(op == MODULO)
+			else if(lhs_val.is_string() && rhs_val.is_string())// S + S
 			{
-				if(lhs_val.is_integer() && rhs_val.is_integer())//if both are integers then good
-				{
-					int l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					curr_val.set(l%r);
-				}
-				else
-					error("mod operator error");
+				std::string l, r;
+				lhs_val.value(l);
+				rhs_val.value(r);
+				l += r;
+				curr_val.set(l);
 			}
-				//Equivalence operators
-			else if(op == EQUAL || op == NOT_EQUAL)
+			else
 			{
-				if(lhs_val.is_integer() && rhs_val.is_integer())
-				{
-					int l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == EQUAL)
-						curr_val.set(l==r);
-					else
-						curr_val.set(l!=r);
-				}
-				else if(lhs_val.is_double() && rhs_val.is_double())
-				{
-					double l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == EQUAL)
-						curr_val.set(l==r);
-					else
-						curr_val.set(l!=r);
-				}
-				else if(lhs_val.is_bool() && rhs_val.is_bool())
-				{
-					bool l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == EQUAL)
-						curr_val.set(l==r);
-					else
-						curr_val.set(l!=r);
-				}
-				else if(lhs_val.is_char() && rhs_val.is_char())
-				{
-					char l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == EQUAL)
-						curr_val.set(l==r);
-					else
-						curr_val.set(l!=r);
-				}
-				else if(lhs_val.is_string() == rhs_val.is_string())
-				{
-					std::string l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == EQUAL)
-						curr_val.set(l==r);
-					else
-						curr_val.set(l!=r);
-				}
-				else//else, throw error
-				{
-					error(node.op->location() + "Expression Equivalence operator error of L: " + lhs_val.to_string() + " R; "+ rhs_val.to_string());
-				}
+				error("unable to add expressions provided");
 			}
-			else if(op == AND || op == OR)
+		}
+	}
+	//More math operators
+	else if(op == MINUS || (op == MULTIPLY || op == DIVIDE))
+	{
+		if(lhs_val.is_integer() && rhs_val.is_integer())
+		{
+			int l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == MINUS)
+				curr_val.set(l-r);
+			else if(op == MULTIPLY)
+				curr_val.set(l*r);
+			else
+				curr_val.set(l/r);
+		}
+		else if(lhs_val.is_double() && rhs_val.is_double())
+		{
+		double l, r;//init variables
+		lhs_val.value(l);//get l's value
+		rhs_val.value(r);//get r's value
+		if(op == MINUS)
+			curr_val.set(l-r);
+		else if(op == MULTIPLY)
+			curr_val.set(l*r);
+		else
+			curr_val.set(l/r);
+		}
+		else
+			error("Simple Arithmetic Error");
+	}
+	//Comparison Operators
+	else if(op == GREATER || op == GREATER_EQUAL || op == LESS || op == LESS_EQUAL)
+	{
+		if(lhs_val.is_integer() && rhs_val.is_integer())
+		{
+			int l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == GREATER)
 			{
-				if(lhs_val.is_bool() == rhs_val.is_bool())
-				{
-					bool l, r;//init variables
-					lhs_val.value(l);//get l's value
-					rhs_val.value(r);//get r's value
-					if(op == AND)
-						curr_val.set(l && r);
-					else
-						curr_val.set(l || r);
-				}
-				else
-					error("AND/OR comparosion operator error");
+				curr_val.set(l>r);
 			}
+			else if(op == GREATER_EQUAL)
+				curr_val.set(l>=r);
+			else if(op == LESS)
+				curr_val.set(l<r);
+			else
+				curr_val.set(l<=r);
+		}
+		else if(lhs_val.is_double() && rhs_val.is_double())//X1 >=,<=,<,> X2 Double
+		{
+			double l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == GREATER)
+				curr_val.set(l>r);
+			else if(op == GREATER_EQUAL)
+				curr_val.set(l>=r);
+			else if(op == LESS)
+				curr_val.set(l<r);
 			else
-				error("Operator Error in expression");
+				curr_val.set(l<=r);
 		}
+		else if(lhs_val.is_char() && rhs_val.is_char())//X1 >=,<=,<,> X2 Char
+		{
+			char l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == GREATER)
+				curr_val.set(l>r);
+			else if(op == GREATER_EQUAL)
+				curr_val.set(l>=r);
+			else if(op == LESS)
+				curr_val.set(l<r);
+			else
+				curr_val.set(l<=r);
+		}
+		else if(lhs_val.is_string() && rhs_val.is_string())//String1 >=,<=,<,> String2
+		{
+			std::string l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value	
+			if(op == GREATER)
+				curr_val.set(l>r);
+			else if(op == GREATER_EQUAL)
+				curr_val.set(l>=r);
+			else if(op == LESS)
+				curr_val.set(l<r);
+			else
+				curr_val.set(l<=r);				  
+		}
+		else if(lhs_val.is_bool() && rhs_val.is_bool()) //Bool1 >=,<=,<,> Bool2
+		{
+			bool l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == GREATER)
+				curr_val.set(l>r);
+			else if(op == GREATER_EQUAL)
+				curr_val.set(l>=r);
+			else if(op == LESS)
+				curr_val.set(l<r);
+			else
+				curr_val.set(l<=r);
+		}
+		else
+			error("Unable to compute comparison operation");
 	}
+	//MOD operator
+	else if(op == MODULO)
+	{
+		if(lhs_val.is_integer() && rhs_val.is_integer())//if both are integers then good
+		{
+			int l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			curr_val.set(l%r);
+		}
+		else
+			error("mod operator error");
+	}
+		//Equivalence operators
+	else if(op == EQUAL || op == NOT_EQUAL)
+	{
+		if(lhs_val.is_integer() && rhs_val.is_integer())
+		{
+			int l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else if(lhs_val.is_double() && rhs_val.is_double())
+		{
+			double l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else if(lhs_val.is_bool() && rhs_val.is_bool())
+		{
+			bool l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else if(lhs_val.is_char() && rhs_val.is_char())
+		{
+			char l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else if(lhs_val.is_oid() && rhs_val.is_oid())
+		{
+			size_t l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else if(lhs_val.is_nil() || rhs_val.is_nil())//only nil is equal to nil
+		{
+			bool same = lhs_val.is_nil() && rhs_val.is_nil();
+			if(op == EQUAL)
+				curr_val.set(same);
+			else
+				curr_val.set(!same);
+		}
+		else if(lhs_val.is_string() == rhs_val.is_string())
+		{
+			std::string l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == EQUAL)
+				curr_val.set(l==r);
+			else
+				curr_val.set(l!=r);
+		}
+		else//else, throw error
+		{
+			error(node.op->location() + "Expression Equivalence operator error of L: " + lhs_val.to_string() + " R; "+ rhs_val.to_string());
+		}
+	}
+	else if(op == AND || op == OR)
+	{
+		if(lhs_val.is_bool() == rhs_val.is_bool())
+		{
+			bool l, r;//init variables
+			lhs_val.value(l);//get l's value
+			rhs_val.value(r);//get r's value
+			if(op == AND)
+				curr_val.set(l && r);
+			else
+				curr_val.set(l || r);
+		}
+		else
+			error("AND/OR comparosion operator error");
+	}
+	else
+		error("Operator Error in expression");
 }
 
 //Simple Term
@@ -775,26 +911,22 @@ void Interpreter::visit(SimpleRValue& node)
 {
 	//set char value
 	if(node.value.type() == CHAR_VAL)
-		curr_val.set(node.value.lexeme().at(0));
-	//set string value
-	else if(node.value.type() == STRING_VAL)
 	{
-		if(node.value.lexeme() == "\n")//check for newline
-		{
-			curr_val.set("");
-			std::cout << "" << std::endl;
-		}
-		else
-		{
-			curr_val.set(node.value.lexeme());
-		}
+		if(!node.parsed)
+			node.parse();
+		curr_val.set(node.char_val);
 	}
-	//int value
+	//set string value (escapes were decoded by the lexer)
+	else if(node.value.type() == STRING_VAL)
+		curr_val.set(node.value.lexeme());
+	//int value (converted on first use)
 	else if(node.value.type() == INT_VAL)
 	{
 		try 
 		{
-			curr_val.set(std::stoi(node.value.lexeme()));
+			if(!node.parsed)
+				node.parse();
+			curr_val.set(node.int_val);
 		}
 		catch(const std::invalid_argument& e) 
 		{
@@ -805,12 +937,14 @@ void Interpreter::visit(SimpleRValue& node)
 			error ("int out of range", node.value);
 		}
 	}
-	//Double value
+	//Double value (converted on first use)
 	else if(node.value.type() == DOUBLE_VAL)
 	{
 		try 
 		{
-			curr_val.set(std::stod(node.value.lexeme()));
+			if(!node.parsed)
+				node.parse();
+			curr_val.set(node.double_val);
 		}
 		catch(const std::invalid_argument& e) 
 		{
@@ -823,10 +957,9 @@ void Interpreter::visit(SimpleRValue& node)
 	}
 	else if(node.value.type() == BOOL_VAL)
 	{
-		if(node.value.lexeme() == "true")
-			curr_val.set(true);
-		else
-			curr_val.set(false);
+		if(!node.parsed)
+			node.parse();
+		curr_val.set(node.bool_val);
 	}  	
 	else if(node.value.type() == NIL)
 		curr_val.set_nil();
@@ -837,24 +970,30 @@ void Interpreter::visit(SimpleRValue& node)
 //New R Value  ... = new Node
 void Interpreter::visit(NewRValue& node)
 {
+	//reclaim unreachable objects once the heap has grown enough (the
+	//fields below are declared in the frame, so they stay reachable)
+	if(heap.needs_collection())
+		collect_garbage();
+
 	//set title and get decl
 	size_t tmp_oid = next_oid;
 	++next_oid;//get next oid
 	std::string type_name = node.type_id.lexeme();//type name
 	TypeDecl* type_node = types[type_name];//get typedecl for type
-	HeapObject type;//create new heap object
+	HeapObject type(type_node->vdecls.size());//create new heap object with the type's shape
 
-	sym_table.push_environment();//push environment
+	push_scope();//push environment
 
+	size_t field = 0;//fields are laid out in declaration order
 	for(VarDeclStmt* s : type_node->vdecls)//traverse ast
 	{
 		//take care of statements of type declaration
 		s->accept(*this);
-		type.set_att(s->id.lexeme(), curr_val);
+		type.set_att(field++, curr_val);
 	}
 
-	sym_table.pop_environment();//pop
-	heap.set_obj(tmp_oid, type);
+	pop_scope();//pop
+	heap.set_obj(tmp_oid, std::move(type));
 	curr_val.set(tmp_oid);//set the value of the current val to the current oid
 }
 
@@ -867,10 +1006,7 @@ void Interpreter::visit(CallExpr& node)
 	if(fun_name == "print")//print(string)
 	{
 		node.arg_list.front()->accept(*this);
-		std::string s = curr_val.to_string();
-		s = std::regex_replace(s, std::regex("\\\\n"), "\n");
-		s = std::regex_replace(s, std::regex("\\\\t"), "\t");
-		std::cout << s;
+		output.write(curr_val.to_string());
 		
 		//NOTE debugger for udf
 		if(step_debugger())
@@ -990,6 +1126,7 @@ void Interpreter::visit(CallExpr& node)
 	else if(fun_name == "read")//reads a value
 	{
 		std::string in;
+		output.flush();//show any prompt before waiting for input
 		std::cin >> in;
 		curr_val.set(in);
 		
@@ -1002,6 +1139,18 @@ void Interpreter::visit(CallExpr& node)
 		  ++curr_step;
 		}
 	}
+	else if(fun_name == "flush")//writes out any buffered output
+	{
+		output.flush();
+		curr_val.set_nil();
+		
+		//NOTE debugger for udf
+		if(step_debugger())
+		{
+			std::cout << "  |#" << curr_step << "| [UDF Flush]" << std::endl;
+		  ++curr_step;
+		}
+	}
 	else if(fun_name == "stod")
 	{
 		node.arg_list.front()->accept(*this);
@@ -1034,30 +1183,20 @@ void Interpreter::visit(CallExpr& node)
 			"][Parameters->";
 			
 		
-		//create a list of the arguments
-		std::list<DataObject> args;
+		//evaluate the arguments (kept as roots until they are bound)
+		size_t first_arg = temp_roots.size();
 		for(Expr* e: node.arg_list)
 		{
 			e->accept(*this);
-			args.push_back(curr_val);
+			temp_roots.push_back(curr_val);
 		}
 
-		//save and set up environment
-		int previous_environment = sym_table.get_environment_id();
-		sym_table.set_environment_id(global_env_id);
-		sym_table.push_environment();
-
-		//get all of the parameter names for function
-		auto x = args.begin();
-		for(FunDecl::FunParam param: fun_node->params)
+		//NOTE print the parameters
+		if(step_rng)
 		{
-			sym_table.add_name(param.id.lexeme());
-			sym_table.set_val_info(param.id.lexeme(), *x);
-			DataObject tmp = *x;
-			//NOTE print the parameters
-			if(step_rng)
-				std::cout << "(" << param.id.lexeme() << "->" << tmp.to_string() << ")";
-			x++;
+			auto x = temp_roots.begin() + first_arg;
+			for(FunDecl::FunParam param: fun_node->params)
+				std::cout << "(" << param.id.lexeme() << "->" << (x++)->to_string() << ")";
 		}
 
 		//NOTE recover step check
@@ -1066,16 +1205,42 @@ void Interpreter::visit(CallExpr& node)
 		step_rng = false;
 		++curr_step;
 
-		//evaluate the statements
-		try
+		//a call in tail position ends the calling function, which then
+		//runs the callee in its own frame (so tail recursion takes no
+		//native stack), leaving the arguments in temp_roots until then
+		if(node.tail)
 		{
-			for(Stmt* s: functions[fun_name]->stmts)
-			s->accept(*this);
-		} catch (MyPLReturnException* e){}
+			tail_fun = fun_node;
+			returning = true;
+			return;
+		}
+
+		//open the function's scope
+		push_scope();
+		bind_params(fun_node, first_arg);
 
-		//pop back out and return to previous environment
-		sym_table.pop_environment();
-		sym_table.set_environment_id(previous_environment);
+		while(true)
+		{
+			//evaluate the statements (up to the first return)
+			for(Stmt* s: fun_node->stmts)
+			{
+				s->accept(*this);
+				if(returning)
+					break;
+			}
+			returning = false;
+			if(!tail_fun)
+				break;
+
+			//reuse the scope for the function called in tail position
+			fun_node = tail_fun;
+			tail_fun = nullptr;
+			frame.resize(scope_base.back());
+			bind_params(fun_node, temp_roots.size() - fun_node->params.size());
+		}
+
+		//drop the function's scope
+		pop_scope();
 	}
 }
 
@@ -1084,8 +1249,7 @@ void Interpreter::visit(IDRValue& node)
 {
 	//Go through path
 	int path_num = 1;
-	DataObject tmp_dat;
-	HeapObject tmp_obj;
+	HeapObject* tmp_obj = nullptr;//read in place
 	size_t tmp_oid;
 
 	for(Token t : node.path)//iterate through lhs. Potentially a path
@@ -1093,25 +1257,28 @@ void Interpreter::visit(IDRValue& node)
 		if(node.path.size() == 1)
 		{
 			//set the current value to 
-			sym_table.get_val_info(t.lexeme(), curr_val);
+			curr_val = var_val(node.var);
 		}
 		else
 		{
 			if(path_num == 1)//a.b.c
 			{
-				sym_table.get_val_info(t.lexeme(), tmp_dat);//get data object that holds the oid
-				tmp_dat.value(tmp_oid);//get the oid
-				heap.get_obj(tmp_oid, tmp_obj);//get heap object i.e. udt
+				//get the oid held by the variable
+				if(!var_val(node.var).value(tmp_oid) || !(tmp_obj = heap.get_obj(tmp_oid)))//get heap object i.e. udt
+					error("attempt to access a field of a nil value");
 			}
 			else//set value to the value in last given id
 			{
-				tmp_obj.get_val(t.lexeme(), curr_val);//set value to attribute or last oid
+				const DataObject& field_val = tmp_obj->field(node.fields[path_num - 2]);
 				if(path_num != node.path.size())//if we aren't on the final element
 				{
-					//set the current oid value to one stored in curr_val
-					curr_val.value(tmp_oid);
-					//tmp_dat.value(tmp_oid);//get the oid
-					heap.get_obj(tmp_oid, tmp_obj);//get heap object i.e. udt
+					//follow the oid stored in the field
+					if(!field_val.value(tmp_oid) || !(tmp_obj = heap.get_obj(tmp_oid)))//get heap object i.e. udt
+						error("attempt to access a field of a nil value");
+				}
+				else
+				{
+					curr_val = field_val;//set value to attribute
 				}
 			}
 		}
@@ -2,33 +2,50 @@
 // NAME: Wesley Muehlhausen
 // FILE: lexer.h
 // DATE: Feb 1, 2020
-// DESC: Implementation of a lexer including the next_token function
+// DESC: Implementation of a lexer including the next_token function.
+//       The lexer scans the raw bytes of a source buffer, and the
+//       tokens it returns refer to their lexemes in place.
 //----------------------------------------------------------------------
 
 #ifndef LEXER_H
 #define LEXER_H
 
 #include <istream>
+#include <memory>
 #include <string>
 #include "token.h"
 #include "mypl_exception.h"
+#include "source_buffer.h"
+#include "byte_scanner.h"
+#include "lexer_tables.h"
 
 
 class Lexer
 {
 public:
 
-  // construct a new lexer from the input stream
+  // construct a new lexer from the input stream (which is read fully
+  // into a source buffer)
   Lexer(std::istream& input_stream);
 
+  // construct a new lexer over a source buffer (e.g., a mapped file)
+  Lexer(std::shared_ptr<SourceBuffer> source);
+
   // return the next available token in the input stream (including
   // EOS if at the end of the stream)
   Token next_token();
+
+  // the buffer the token lexemes point into (which must be kept
+  // alive for as long as the tokens are used)
+  std::shared_ptr<SourceBuffer> source() const;
   
 private:
 
-  // input stream, current line, and current column
-  std::istream& input_stream;
+  // source buffer, next unread byte, current line, and current column
+  std::shared_ptr<SourceBuffer> source_buffer;
+  const char* pos;
+  const char* end;
+  bool at_eof;
   int line;
   int column;
 
@@ -38,26 +55,71 @@ private:
   // return a single character from the input stream without advancing
   char peek();
 
+  // advance past the string literal characters that need no special
+  // handling (up to a quote, backslash, or newline)
+  void skip_string_chars();
+
+  // the characters from start up to stop with their \n and \t escapes
+  // decoded (any other backslash is kept as is)
+  std::string decode(const char* start, const char* stop) const;
+
   // create and throw a mypl_exception (exits the lexer)
   void error(const std::string& msg, int line, int column) const;
 };
 
 
 Lexer::Lexer(std::istream& input_stream)
-  : input_stream(input_stream), line(1), column(1)
+  : Lexer(std::make_shared<SourceBuffer>(input_stream))
+{
+}
+
+
+Lexer::Lexer(std::shared_ptr<SourceBuffer> source)
+  : source_buffer(source), pos(source->begin()), end(source->end()),
+    at_eof(false), line(1), column(1)
 {
 }
 
 
+std::shared_ptr<SourceBuffer> Lexer::source() const
+{
+  return source_buffer;
+}
+
+
 char Lexer::read()
 {
-  return input_stream.get();
+  if (pos < end)
+    return *pos++;
+  at_eof = true;
+  return EOF;
 }
 
 
 char Lexer::peek()
 {
-  return input_stream.peek();
+  return pos < end ? *pos : EOF;
+}
+
+
+void Lexer::skip_string_chars()
+{
+  const char* stop = byte_scanner().find_any(pos, end, '"', '\\', '\n');
+  column += stop - pos;
+  pos = stop;
+}
+
+
+std::string Lexer::decode(const char* start, const char* stop) const
+{
+  std::string out_string;
+  for (const char* p = start; p < stop; ++p) {
+    if (*p == '\\' and p + 1 < stop and (p[1] == 'n' or p[1] == 't'))
+      out_string += (*++p == 'n') ? '\n' : '\t';
+    else
+      out_string += *p;
+  }
+  return out_string;
 }
 
 
@@ -72,10 +134,9 @@ Token Lexer::next_token()
   
  //Build Token 
   int temp_col;
-  std::string lexeme = "";//current lexeme
+  const char* start;//start of the current lexeme in the source
   char ch;
   ch = read();//read first chararcter
-  lexeme += ch;
   
   ////////////////////////////////////////////////
   //1) Read through the whitespace and/or comments  
@@ -90,11 +151,14 @@ Token Lexer::next_token()
   			temp_col = column;
   			++line;
   	}
-  	//while next character is whitespace, continue;
-  	else if(std::isspace(ch))
+  	//while next character is whitespace, continue (skipping the
+  	//rest of the run of blanks at once);
+  	else if(has_class(ch, CC_SPACE))
   	{
+  			const char* stop = byte_scanner().skip_blanks(pos, end);
+  			column += 1 + (stop - pos);
+  			pos = stop;
   			ch = read();
-  			++column;
   			temp_col = column;
   	}
   	//check for comments
@@ -102,25 +166,17 @@ Token Lexer::next_token()
   	{		
   			if(ch == '#')//if a comment line
   			{
+  				//skip to the end of the line (or of the file)
+  				const char* stop = byte_scanner().find_any(pos, end, '\n', '\n', '\n');
+  				column += 1 + (stop - pos);
+  				pos = stop;
   				ch = read();
-  				column++;
-  				bool contin = true;
-  				while(contin == true)
+  				if(ch == '\n')//no comment on next line
   				{
-
-  					if(ch == '\n')//no comment on next line
-  					{
-  						column = 1;
-  						++line; 
-  						ch = read();
-  						contin = false;
-  					}
-					else//for newline
-  					{
-  						ch = read();
-  						column++;
-  					}
-  				} 				
+  					column = 1;
+  					++line; 
+  					ch = read();
+  				}
   			}
 			else
 			{
@@ -133,39 +189,40 @@ Token Lexer::next_token()
   //////////////////////////////////////////////////
   //2) check for the end-of-file (return  EOS token)
   if(ch == EOF)
-  	return Token(EOS , "" , line , column);
+  	return Token(EOS , "" , 0 , line , column);
+  start = pos - 1;
   
   //////////////////////////////////////////////
   //3)check for simple, single character symbols  	
   if(ch == '(')
-  	return Token(LPAREN , "(" , line , column++);
+  	return Token(LPAREN , start , 1 , line , column++);
 	
   else if(ch == ')')
-  	return Token(RPAREN , ")" , line , column++);
+  	return Token(RPAREN , start , 1 , line , column++);
   	
   else if(ch == ':')
-  	return Token(COLON , ":" , line , column++);
+  	return Token(COLON , start , 1 , line , column++);
   	
   else if(ch == '.')
-  	return Token(DOT , "." , line , column++);
+  	return Token(DOT , start , 1 , line , column++);
   	
   else if(ch == ',')
-  	return Token(COMMA , "," , line , column++);
+  	return Token(COMMA , start , 1 , line , column++);
   	
   else if(ch == '-')
-  	return Token(MINUS , "-" , line , column++);
+  	return Token(MINUS , start , 1 , line , column++);
   	
   else if(ch == '*')
-  	return Token(MULTIPLY , "*" , line , column++);
+  	return Token(MULTIPLY , start , 1 , line , column++);
   	
   else if(ch == '/')
-  	return Token(DIVIDE , "/" , line , column++);
+  	return Token(DIVIDE , start , 1 , line , column++);
   	
   else if(ch == '+')
-  	return Token(PLUS , "+" , line , column++);
+  	return Token(PLUS , start , 1 , line , column++);
   	
   else if(ch == '%')
-  	return Token(MODULO , "%" , line , column++);
+  	return Token(MODULO , start , 1 , line , column++);
 
   /////////////////////////////////////
   //4) check for more invlolved symbols i.e. == = <= < != etc. 
@@ -176,7 +233,7 @@ Token Lexer::next_token()
   		read();
   		temp_col = column;
   		column += 2;
-  		return Token(NOT_EQUAL , "!=" , line , temp_col);
+  		return Token(NOT_EQUAL , start , 2 , line , temp_col);
   	}
   	else
   		error("Incorrect use of !", line, column);
@@ -189,10 +246,10 @@ Token Lexer::next_token()
   		read();
   		temp_col = column;
   		column += 2;
-  		return Token(EQUAL , "==" , line , temp_col);
+  		return Token(EQUAL , start , 2 , line , temp_col);
   	}
   	else
-  		return Token(ASSIGN , "=" , line , column++);
+  		return Token(ASSIGN , start , 1 , line , column++);
   }
 	
   else if(ch == '<' || ch == '>')//check for < > <= >=
@@ -203,16 +260,16 @@ Token Lexer::next_token()
   			temp_col = column;
   			column += 2;
   			if(ch == '<')
-				return Token(LESS_EQUAL , "<=" , line , temp_col);
+				return Token(LESS_EQUAL , start , 2 , line , temp_col);
 			else
-				return Token(GREATER_EQUAL , ">=" , line , temp_col);
+				return Token(GREATER_EQUAL , start , 2 , line , temp_col);
   		}
   		else
   		{
   			if(ch == '<')
-  				return Token(LESS , "<" , line , column++);
+  				return Token(LESS , start , 1 , line , column++);
   			else
-  				return Token(GREATER , ">" , line , column++);
+  				return Token(GREATER , start , 1 , line , column++);
   				
   		}
   }
@@ -221,38 +278,27 @@ Token Lexer::next_token()
   //5) check for character values
   
   //set up and check for first quote
-  lexeme = "";
-  lexeme += ch;
   int tmpcol = column;
-  std::string next = "";
-  next += peek();
   
   //if found first quote, continue...
-  if(next == "'")
+  if(peek() == '\'')
   	error("Incomplete Char Value", line, column);
-  if(lexeme == "'")//if first quote found, continue
+  if(ch == '\'')//if first quote found, continue
   {
   	//check to see if next character is in the list of possible characters
   	char tmp = peek();//see if next character is valid
   	bool found = false;
-  	if(std::isalpha(tmp) == 1024 || std::isdigit(tmp) == true)
+  	if(has_class(tmp, CC_ALPHA) || has_class(tmp, CC_DIGIT))
   		found = true;
   	if(found == true)//if it is found, then check for the next character to see if it fits
   	{
   		column++;
   		ch = read();//advance
-  		std::string char_val = "";
-  		char_val += ch;
-  		lexeme += ch;
-  		std::string temp = "";
-  		tmp = peek();
-  		temp += tmp;
-  		if(temp == "'")//check for final quote
+  		if(peek() == '\'')//check for final quote
   		{
   			column+=2;
   			ch = read();
-  			lexeme += ch;
-  			return Token(CHAR_VAL , char_val , line , tmpcol);
+  			return Token(CHAR_VAL , pos - 2 , 1 , line , tmpcol);
   		}
   		else//else trigger errors
   		{
@@ -271,44 +317,49 @@ Token Lexer::next_token()
   //check for first quote
   if(ch == '"')
   {
-  	std::string out_string = "";
-  	ch = read();
   	int tmp = column;
+  	bool escaped = false;
+  	start = pos;
   	column++;
-  	if(ch == '"')//check for empty quote case
-  	{
-  		column++;
-  		return Token(STRING_VAL , "" , line , tmp);
-  	}
-  	out_string += ch;
+  	skip_string_chars();
+  	ch = read();
   	while(ch != '"')//while not at the end of the string or at the end of the file
   	{
-  			if(ch == '\n')
-  				error("Incomplete String", line, column);
-  	
-  			//std::cout << ch << std::endl;
+  		//column is still the column of ch here
+  		if(ch == '\n' || at_eof)
+  			error("Incomplete String", line, column);
+  		++column;
+
+  		//skip over \n and \t (any other backslash is kept as is)
+  		if(ch == '\\' && (peek() == 'n' || peek() == 't'))
+  		{
+  			escaped = true;
   			ch = read();
   			++column;
-  			if(ch != '"')
-  				out_string += ch;
-  				
+  		}
+  		skip_string_chars();
+  		ch = read();
   	}
   	++column;
-  	return Token(STRING_VAL , out_string , line , tmp);
+  	//the lexeme is the source text unless escapes must be decoded
+  	//(the only lexemes that are copied)
+  	if(escaped)
+  		return Token(STRING_VAL , decode(start, pos - 1) , line , tmp);
+  	return Token(STRING_VAL , start , pos - 1 - start , line , tmp);
   }
   
   //////////////////////////////////////////////
   //7)check for numeric values(ints and doubles)
   bool found = false;
   bool is_double = false;
-  if(std::isdigit(ch) == true)
+  if(has_class(ch, CC_DIGIT))
   	found = true;
   if(found == true)//if this is a number...
   {
   	while(found == true)//keep on checking if char is a number or decimal
   	{
   		found = false;
-  		if(std::isdigit(peek()) == true || peek() == '.')
+  		if(has_class(peek(), CC_DIGIT) || peek() == '.')
   		{
   			found = true;
   			if(peek() == '.' && is_double == true)//if the decimal is already used
@@ -316,158 +367,27 @@ Token Lexer::next_token()
   			else if(peek() == '.' && is_double == false)//if first time declaring double val
   					is_double = true;
   				ch = read();
-  				lexeme += ch;
   				column++;
   				found = true;
   		}
   	}
   	if(is_double == true)//double
-  		return Token(DOUBLE_VAL , lexeme , line , column);
+  		return Token(DOUBLE_VAL , start , pos - start , line , column);
   	else//int
-  		return Token(INT_VAL , lexeme , line , column);
+  		return Token(INT_VAL , start , pos - start , line , column);
   }
   
   //8)check for reserved words/ids (letter followed by letter, number or '\_')
-  bool cont = true;
-  char tmpc;
   tmpcol = column;
   column++;
-  //continually build lexer and check if any of them are matches, if not then ID
-  while(cont == true)
+  //build the whole lexeme, then look it up in the reserved word table
+  //(if it is not there, it is an ID)
+  while(has_class(peek(), CC_ID))
   {
-  	
-  	tmpc = peek();
-  	if((std::isdigit(tmpc) == false && std::isalpha(tmpc) == false) && tmpc != '_')
-  	{
-		if(lexeme == "bool")
-		{
-			return Token(BOOL_TYPE, lexeme, line, tmpcol);
-		}
-		else if(lexeme == "char")
-		{
-			return Token(CHAR_TYPE, lexeme, line, tmpcol);	
-		}
-		else if(lexeme == "do" && peek() != 'u')
-		{
-			return Token(DO, lexeme, line, tmpcol);	
-		}
-		else if(lexeme == "true")
-		{
-			return Token(BOOL_VAL, lexeme, line, tmpcol);
-		}
-		
-		else if(lexeme == "neg")
-		{
-			return Token(NEG, lexeme, line, tmpcol);
-		}
-		else if(lexeme == "and")
-		{
-			return Token(AND, lexeme, line, tmpcol);
-		}
-		else if(lexeme == "or")
-		{
-			return Token(OR, lexeme, line, tmpcol);
-		}
-		else if(lexeme == "not")
-		{
-			return Token(NOT, lexeme, line, tmpcol);
-		}
-		
-		else if(lexeme == "nil")
-		{
-			return Token( NIL , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "false")
-		{
-			return Token( BOOL_VAL , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "double")
-		{
-			return Token( DOUBLE_TYPE , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "else" && peek() != 'i')
-		{
-			return Token( ELSE , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "elseif")
-		{
-			return Token( ELSEIF , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "end")
-		{
-			return Token( END , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "for")
-		{
-			return Token( FOR , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "fun")
-		{
-			return Token( FUN , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "if")
-		{
-			return Token( IF , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "int")
-		{
-			return Token( INT_TYPE , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "new")
-		{
-			return Token( NEW , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "return")
-		{
-			return Token( RETURN , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "string")
-		{
-			return Token( STRING_TYPE , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "then")
-		{
-			return Token( THEN , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "to")
-		{
-			return Token( TO , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "type")
-		{
-			return Token( TYPE , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "var")
-		{
-			return Token( VAR , lexeme, line, tmpcol);
-		}
-		else if(lexeme == "while")
-		{
-			return Token( WHILE , lexeme, line, tmpcol);
-		}
-	}
-	if(peek() == '\n')//if the next character is a space
-	{
-		return Token(ID , lexeme , line , tmpcol);
-	}
-	else if(std::isspace(tmpc))
-	{
-		return Token(ID , lexeme , line , tmpcol);
-	}
-	else if((std::isalpha(tmpc) == false && std::isdigit(tmpc) == false) && tmpc != '_')
-	{
-		return Token(ID , lexeme , line , tmpcol);
-	}
-	else//else, keep on going
-	{
-		ch = read();
-		column++;
-		lexeme += ch;
-	}
+	read();
+	column++;
   }
-  
-  //otherwise, end
-  return Token(EOS , "" , line , column);
+  return Token(keyword_type(start, pos - start) , start , pos - start , line , tmpcol);
 }
 
 
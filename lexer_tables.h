@@ -0,0 +1,191 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: lexer_tables.h
+// DATE: Oct 16, 2026
+// DESC: Lookup tables for the lexer, generated at compile time: the
+//       class of every byte (replacing the <cctype> calls) and a
+//       perfect hash of the reserved words, so an identifier is
+//       classified with one table lookup and one final comparison
+//       against the only keyword it could be.
+//----------------------------------------------------------------------
+
+#ifndef LEXER_TABLES_H
+#define LEXER_TABLES_H
+
+#include <cstddef>
+#include <cstring>
+#include "token.h"
+
+
+//----------------------------------------------------------------------
+// COMPILE-TIME TABLE GENERATION
+//----------------------------------------------------------------------
+
+// the integers 0 to N-1 as a template parameter pack
+template<unsigned... Is> struct Indexes {};
+
+template<unsigned N, unsigned... Is>
+struct MakeIndexes : MakeIndexes<N - 1, N - 1, Is...> {};
+
+template<unsigned... Is>
+struct MakeIndexes<0, Is...>
+{
+  typedef Indexes<Is...> type;
+};
+
+
+//----------------------------------------------------------------------
+// CHARACTER CLASSES
+//----------------------------------------------------------------------
+
+// character class bits (the C locale <cctype> classes the lexer used)
+enum CharClass {
+  CC_SPACE = 1,                 // isspace (including newlines)
+  CC_DIGIT = 2,                 // isdigit
+  CC_ALPHA = 4,                 // isalpha
+  CC_ID = 8                     // letters, digits, and '_'
+};
+
+constexpr unsigned char char_class(unsigned c)
+{
+  return (c == ' ' or (c >= '\t' and c <= '\r') ? CC_SPACE : 0) |
+    (c >= '0' and c <= '9' ? CC_DIGIT | CC_ID : 0) |
+    ((c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') ? CC_ALPHA | CC_ID : 0) |
+    (c == '_' ? CC_ID : 0);
+}
+
+template<typename T> struct CharClassTable;
+
+template<unsigned... Is>
+struct CharClassTable<Indexes<Is...>>
+{
+  static constexpr unsigned char classes[sizeof...(Is)] = {char_class(Is)...};
+};
+
+template<unsigned... Is>
+constexpr unsigned char CharClassTable<Indexes<Is...>>::classes[];
+
+typedef CharClassTable<MakeIndexes<256>::type> CHAR_CLASSES;
+
+static_assert(CHAR_CLASSES::classes['_'] == CC_ID and
+              CHAR_CLASSES::classes['\n'] == CC_SPACE and
+              CHAR_CLASSES::classes[255] == 0, "bad character class table");
+
+
+// true if the byte has the given class (EOF has none)
+bool has_class(char c, CharClass cc)
+{
+  return CHAR_CLASSES::classes[static_cast<unsigned char>(c)] & cc;
+}
+
+
+//----------------------------------------------------------------------
+// RESERVED WORDS
+//----------------------------------------------------------------------
+
+struct Keyword
+{
+  const char* word;
+  TokenType type;
+};
+
+constexpr Keyword KEYWORDS[] = {
+  {"bool", BOOL_TYPE}, {"char", CHAR_TYPE}, {"double", DOUBLE_TYPE},
+  {"int", INT_TYPE}, {"string", STRING_TYPE}, {"true", BOOL_VAL},
+  {"false", BOOL_VAL}, {"nil", NIL}, {"neg", NEG}, {"and", AND},
+  {"or", OR}, {"not", NOT}, {"type", TYPE}, {"while", WHILE},
+  {"for", FOR}, {"to", TO}, {"do", DO}, {"if", IF}, {"then", THEN},
+  {"elseif", ELSEIF}, {"else", ELSE}, {"end", END}, {"fun", FUN},
+  {"var", VAR}, {"return", RETURN}, {"new", NEW}
+};
+
+constexpr unsigned KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+
+// every keyword is 2 to 6 characters long, so shorter or longer ids
+// skip the lookup
+constexpr size_t MIN_KEYWORD_LENGTH = 2;
+constexpr size_t MAX_KEYWORD_LENGTH = 6;
+
+// the number of hash table slots (a power of two)
+constexpr unsigned KEYWORD_SLOTS = 64;
+
+constexpr size_t word_length(const char* s)
+{
+  return *s ? 1 + word_length(s + 1) : 0;
+}
+
+// the hash of a word of at least two characters (the multipliers were
+// picked so that no two keywords collide, which is checked below)
+constexpr unsigned keyword_hash(const char* s, size_t length)
+{
+  return (static_cast<unsigned char>(s[0]) +
+          31 * static_cast<unsigned char>(s[1]) +
+          static_cast<unsigned char>(s[length - 1]) + 26 * length) &
+    (KEYWORD_SLOTS - 1);
+}
+
+constexpr unsigned keyword_hash(unsigned k)
+{
+  return keyword_hash(KEYWORDS[k].word, word_length(KEYWORDS[k].word));
+}
+
+// the index of the keyword with the given hash (-1 if none) from k on
+constexpr int keyword_with_hash(unsigned hash, unsigned k = 0)
+{
+  return k == KEYWORD_COUNT ? -1 :
+    keyword_hash(k) == hash ? k : keyword_with_hash(hash, k + 1);
+}
+
+// true if keywords k and later all have distinct hashes (and lengths
+// in range)
+constexpr bool perfect_from(unsigned k = 0)
+{
+  return k == KEYWORD_COUNT or
+    (keyword_with_hash(keyword_hash(k)) == static_cast<int>(k) and
+     word_length(KEYWORDS[k].word) >= MIN_KEYWORD_LENGTH and
+     word_length(KEYWORDS[k].word) <= MAX_KEYWORD_LENGTH and
+     perfect_from(k + 1));
+}
+
+static_assert(perfect_from(), "keyword hash is not perfect");
+
+template<typename T> struct KeywordTable;
+
+template<unsigned... Is>
+struct KeywordTable<Indexes<Is...>>
+{
+  // the keyword index of each hash slot (-1 for an empty slot)
+  static constexpr signed char slots[sizeof...(Is)] = {
+    static_cast<signed char>(keyword_with_hash(Is))...
+  };
+};
+
+template<unsigned... Is>
+constexpr signed char KeywordTable<Indexes<Is...>>::slots[];
+
+typedef KeywordTable<MakeIndexes<KEYWORD_SLOTS>::type> KEYWORD_TABLE;
+
+
+//----------------------------------------------------------------------
+// The token type of an identifier or reserved word.
+// Inputs:
+//   start -- the first character of the lexeme
+//   length -- the number of characters in the lexeme
+// Returns:
+//   the keyword's token type, or ID if the lexeme is not reserved
+//----------------------------------------------------------------------
+TokenType keyword_type(const char* start, size_t length)
+{
+  if (length < MIN_KEYWORD_LENGTH or length > MAX_KEYWORD_LENGTH)
+    return ID;
+  int k = KEYWORD_TABLE::slots[keyword_hash(start, length)];
+  // the lexeme must be exactly the keyword (strncmp stops at the end of
+  // a shorter keyword)
+  if (k < 0 or std::strncmp(start, KEYWORDS[k].word, length) != 0 or
+      KEYWORDS[k].word[length] != '\0')
+    return ID;
+  return KEYWORDS[k].type;
+}
+
+
+#endif
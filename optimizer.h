@@ -0,0 +1,638 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: optimizer.h
+// DATE: Oct 16, 2026
+// DESC: Simplifies a checked and resolved AST before it is run. Any
+//       expression whose operands are all constants is replaced by a
+//       literal. That covers operators, not and neg, and the pure
+//       built-ins (itos, dtos, length, get, stoi, stod). Variables
+//       that are never assigned after their declaration are replaced
+//       by their literal value. An operation that would fail at
+//       runtime (such as a division by zero) is left alone, so it
+//       still fails when and if it runs.
+//
+//       The optimizer runs twice over the program. The first pass
+//       finds the variables that are assigned to, and the second one
+//       folds. Variables are tracked by the resolver's (depth, slot)
+//       pairs, with scopes opened exactly where the resolver opens
+//       them.
+//----------------------------------------------------------------------
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+#include "data_object.h"
+
+
+class Optimizer : public Visitor
+{
+public:
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+  // the number of expressions replaced by literals
+  int folded() const {return fold_count;}
+
+private:
+
+  // what is known about a declared variable
+  struct VarInfo
+  {
+    bool assigned = false;              // assigned after declaration
+    SimpleRValue* literal = nullptr;    // its value if it is constant
+  };
+
+  // the arena of the program being optimized (for new literals)
+  Arena* arena = nullptr;
+
+  // true during the first pass (which only finds assignments)
+  bool scanning = false;
+
+  // every declared variable, and the variables of each open scope in
+  // slot order (null for parameters and loop variables)
+  std::unordered_map<VarDeclStmt*, VarInfo> vars;
+  std::vector<std::vector<VarInfo*>> scopes;
+
+  // the value of the last expression visited, if it is constant
+  bool curr_const = false;
+  DataObject curr_val;
+
+  int fold_count = 0;
+
+  // scope helpers
+  void push_scope();
+  void pop_scope();
+  VarInfo* lookup(const VarSlot& var);
+  void stmts(Span<Stmt*>& stmt_list);
+
+  // folding helpers
+  bool literal_value(SimpleRValue& node, DataObject& val);
+  SimpleRValue* make_literal(const DataObject& val, const Token& at);
+  bool fold_binary(TokenType op, const DataObject& lhs,
+                   const DataObject& rhs, DataObject& result);
+  bool fold_call(const std::string& fun_name,
+                 const std::vector<DataObject>& args, DataObject& result);
+  void to_literal(Expr& node);
+  void unwrap(Expr& node);
+};
+
+
+//----------------------------------------------------------------------
+// HELPER FUNCTIONS
+//----------------------------------------------------------------------
+
+void Optimizer::push_scope()
+{
+  scopes.push_back(std::vector<VarInfo*>());
+}
+
+
+void Optimizer::pop_scope()
+{
+  scopes.pop_back();
+}
+
+
+// the variable at the resolved location (null if it is not tracked)
+Optimizer::VarInfo* Optimizer::lookup(const VarSlot& var)
+{
+  if (var.depth < 0 or var.depth >= (int)scopes.size())
+    return nullptr;
+  std::vector<VarInfo*>& scope = scopes[scopes.size() - 1 - var.depth];
+  if (var.slot < 0 or var.slot >= (int)scope.size())
+    return nullptr;
+  return scope[var.slot];
+}
+
+
+void Optimizer::stmts(Span<Stmt*>& stmt_list)
+{
+  push_scope();
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+  pop_scope();
+}
+
+
+// the value of a literal (false for nil and for a literal that does not
+// convert, which is left to fail at runtime)
+bool Optimizer::literal_value(SimpleRValue& node, DataObject& val)
+{
+  TokenType type = node.value.type();
+  if (type == STRING_VAL) {
+    val.set(node.value.lexeme());
+    return true;
+  }
+  if (type != INT_VAL and type != DOUBLE_VAL and type != BOOL_VAL and
+      type != CHAR_VAL)
+    return false;
+  try {
+    if (!node.parsed)
+      node.parse();
+  } catch (const std::exception& e) {
+    return false;
+  }
+  if (type == INT_VAL)
+    val.set(node.int_val);
+  else if (type == DOUBLE_VAL)
+    val.set(node.double_val);
+  else if (type == BOOL_VAL)
+    val.set(node.bool_val);
+  else
+    val.set(node.char_val);
+  return true;
+}
+
+
+// a new literal holding the value (at the given token's location)
+SimpleRValue* Optimizer::make_literal(const DataObject& val, const Token& at)
+{
+  SimpleRValue* literal = arena->make<SimpleRValue>();
+  TokenType type = STRING_VAL;
+  std::string lexeme;
+  if (val.is_integer()) {
+    type = INT_VAL;
+    val.value(literal->int_val);
+    lexeme = std::to_string(literal->int_val);
+  }
+  else if (val.is_double()) {
+    type = DOUBLE_VAL;
+    val.value(literal->double_val);
+    // enough digits to convert back to the same double
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", literal->double_val);
+    lexeme = buffer;
+  }
+  else if (val.is_bool()) {
+    type = BOOL_VAL;
+    val.value(literal->bool_val);
+    lexeme = literal->bool_val ? "true" : "false";
+  }
+  else if (val.is_char()) {
+    type = CHAR_VAL;
+    val.value(literal->char_val);
+    lexeme = std::string(1, literal->char_val);
+  }
+  else
+    val.value(lexeme);
+  literal->parsed = type != STRING_VAL;
+  // the lexeme lives as long as the program
+  char* chars = static_cast<char*>(arena->allocate(lexeme.size() + 1, 1));
+  std::memcpy(chars, lexeme.c_str(), lexeme.size() + 1);
+  literal->value = Token(type, chars, lexeme.size(), at.line(), at.column());
+  return literal;
+}
+
+
+// apply a binary operator to two constants the way the interpreter
+// does, returning false if it cannot be folded
+bool Optimizer::fold_binary(TokenType op, const DataObject& lhs,
+                            const DataObject& rhs, DataObject& result)
+{
+  if (lhs.type() != rhs.type()) {
+    // only char and string concatenation mixes types
+    if (op != PLUS or !(lhs.is_char() or lhs.is_string()) or
+        !(rhs.is_char() or rhs.is_string()))
+      return false;
+  }
+  if (lhs.is_integer()) {
+    int l = 0, r = 0;
+    lhs.value(l);
+    rhs.value(r);
+    // int arithmetic wraps around (as it does at runtime)
+    unsigned ul = l, ur = r;
+    switch (op) {
+      case PLUS: result.set(static_cast<int>(ul + ur)); return true;
+      case MINUS: result.set(static_cast<int>(ul - ur)); return true;
+      case MULTIPLY: result.set(static_cast<int>(ul * ur)); return true;
+      case DIVIDE:
+      case MODULO:
+        // division by zero (or overflow) is left to happen at runtime
+        if (r == 0 or (l == INT_MIN and r == -1))
+          return false;
+        result.set(op == DIVIDE ? l / r : l % r);
+        return true;
+      case LESS: result.set(l < r); return true;
+      case LESS_EQUAL: result.set(l <= r); return true;
+      case GREATER: result.set(l > r); return true;
+      case GREATER_EQUAL: result.set(l >= r); return true;
+      case EQUAL: result.set(l == r); return true;
+      case NOT_EQUAL: result.set(l != r); return true;
+      default: return false;
+    }
+  }
+  if (lhs.is_double()) {
+    double l = 0, r = 0;
+    lhs.value(l);
+    rhs.value(r);
+    double val = 0;
+    switch (op) {
+      case PLUS: val = l + r; break;
+      case MINUS: val = l - r; break;
+      case MULTIPLY: val = l * r; break;
+      case DIVIDE: val = l / r; break;
+      case LESS: result.set(l < r); return true;
+      case LESS_EQUAL: result.set(l <= r); return true;
+      case GREATER: result.set(l > r); return true;
+      case GREATER_EQUAL: result.set(l >= r); return true;
+      case EQUAL: result.set(l == r); return true;
+      case NOT_EQUAL: result.set(l != r); return true;
+      default: return false;
+    }
+    // infinities and nans have no literal
+    if (!std::isfinite(val))
+      return false;
+    result.set(val);
+    return true;
+  }
+  if (lhs.is_bool()) {
+    bool l = false, r = false;
+    lhs.value(l);
+    rhs.value(r);
+    switch (op) {
+      case AND: result.set(l && r); return true;
+      case OR: result.set(l || r); return true;
+      case LESS: result.set(l < r); return true;
+      case LESS_EQUAL: result.set(l <= r); return true;
+      case GREATER: result.set(l > r); return true;
+      case GREATER_EQUAL: result.set(l >= r); return true;
+      case EQUAL: result.set(l == r); return true;
+      case NOT_EQUAL: result.set(l != r); return true;
+      default: return false;
+    }
+  }
+  if (op == PLUS) {
+    // char and string concatenation (always a string)
+    std::string l, r;
+    char c = 0;
+    if (!lhs.value(l) and lhs.value(c))
+      l = std::string(1, c);
+    if (!rhs.value(r) and rhs.value(c))
+      r = std::string(1, c);
+    result.set(l + r);
+    return true;
+  }
+  if (lhs.is_char()) {
+    char l = 0, r = 0;
+    lhs.value(l);
+    rhs.value(r);
+    switch (op) {
+      case LESS: result.set(l < r); return true;
+      case LESS_EQUAL: result.set(l <= r); return true;
+      case GREATER: result.set(l > r); return true;
+      case GREATER_EQUAL: result.set(l >= r); return true;
+      case EQUAL: result.set(l == r); return true;
+      case NOT_EQUAL: result.set(l != r); return true;
+      default: return false;
+    }
+  }
+  if (lhs.is_string()) {
+    std::string l, r;
+    lhs.value(l);
+    rhs.value(r);
+    switch (op) {
+      case LESS: result.set(l < r); return true;
+      case LESS_EQUAL: result.set(l <= r); return true;
+      case GREATER: result.set(l > r); return true;
+      case GREATER_EQUAL: result.set(l >= r); return true;
+      case EQUAL: result.set(l == r); return true;
+      case NOT_EQUAL: result.set(l != r); return true;
+      default: return false;
+    }
+  }
+  return false;
+}
+
+
+// call a pure built-in on constant arguments, returning false if it is
+// not one or if the call would fail
+bool Optimizer::fold_call(const std::string& fun_name,
+                          const std::vector<DataObject>& args,
+                          DataObject& result)
+{
+  if (fun_name == "itos" and args.size() == 1 and args[0].is_integer()) {
+    int val = 0;
+    args[0].value(val);
+    result.set(std::to_string(val));
+    return true;
+  }
+  if (fun_name == "dtos" and args.size() == 1 and args[0].is_double()) {
+    double val = 0;
+    args[0].value(val);
+    result.set(std::to_string(val));
+    return true;
+  }
+  if (fun_name == "length" and args.size() == 1 and args[0].is_string()) {
+    std::string val;
+    args[0].value(val);
+    result.set(static_cast<int>(val.length()));
+    return true;
+  }
+  if (fun_name == "get" and args.size() == 2 and args[0].is_integer() and
+      args[1].is_string()) {
+    int index = 0;
+    std::string val;
+    args[0].value(index);
+    args[1].value(val);
+    if (index < 0 or index >= (int)val.length())
+      return false;
+    result.set(val.at(index));
+    return true;
+  }
+  if ((fun_name == "stoi" or fun_name == "stod") and args.size() == 1 and
+      args[0].is_string()) {
+    std::string val;
+    args[0].value(val);
+    try {
+      if (fun_name == "stoi")
+        result.set(std::stoi(val));
+      else
+        result.set(std::stod(val));
+    } catch (const std::exception& e) {
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+
+// replace the expression by the current (constant) value
+void Optimizer::to_literal(Expr& node)
+{
+  SimpleTerm* term = arena->make<SimpleTerm>();
+  term->rvalue = make_literal(curr_val, node.first_token());
+  node.negated = false;
+  node.first = term;
+  node.op = nullptr;
+  node.rest = nullptr;
+  ++fold_count;
+}
+
+
+// drop the parentheses around a first term that is a single term
+void Optimizer::unwrap(Expr& node)
+{
+  Expr* nested = node.first->nested_expr();
+  if (nested and !nested->negated and !nested->op)
+    node.first = nested->first;
+}
+
+
+//----------------------------------------------------------------------
+// TOP-LEVEL
+//----------------------------------------------------------------------
+
+void Optimizer::visit(Program& node)
+{
+  arena = &node.arena;
+  // first find the variables that are assigned to, then fold
+  scanning = true;
+  for (Decl* d : node.decls)
+    d->accept(*this);
+  scanning = false;
+  for (Decl* d : node.decls)
+    d->accept(*this);
+}
+
+
+void Optimizer::visit(FunDecl& node)
+{
+  // parameters take the first slots of the function's scope
+  push_scope();
+  for (size_t i = 0; i < node.params.size(); ++i)
+    scopes.back().push_back(nullptr);
+  for (Stmt* s : node.stmts)
+    s->accept(*this);
+  pop_scope();
+}
+
+
+void Optimizer::visit(TypeDecl& node)
+{
+  // field initializers run in a scope of their own
+  push_scope();
+  for (VarDeclStmt* v : node.vdecls)
+    v->accept(*this);
+  pop_scope();
+}
+
+
+//----------------------------------------------------------------------
+// STATEMENTS
+//----------------------------------------------------------------------
+
+void Optimizer::visit(VarDeclStmt& node)
+{
+  VarInfo& info = vars[&node];
+  if (!scanning) {
+    node.expr->accept(*this);
+    // a variable that is never assigned keeps its initial value
+    Expr* e = node.expr;
+    SimpleTerm* term = dynamic_cast<SimpleTerm*>(e->first);
+    if (!info.assigned and !e->negated and !e->op and term)
+      info.literal = dynamic_cast<SimpleRValue*>(term->rvalue);
+    if (info.literal and info.literal->value.type() == NIL)
+      info.literal = nullptr;
+  }
+  scopes.back().push_back(&info);
+}
+
+
+void Optimizer::visit(AssignStmt& node)
+{
+  if (scanning) {
+    // assigning a field of the variable's object does not change the
+    // variable itself
+    VarInfo* info = lookup(node.var);
+    if (info and node.lvalue_list.size() == 1)
+      info->assigned = true;
+    return;
+  }
+  node.expr->accept(*this);
+}
+
+
+void Optimizer::visit(ReturnStmt& node)
+{
+  if (!scanning)
+    node.expr->accept(*this);
+}
+
+
+void Optimizer::visit(IfStmt& node)
+{
+  if (!scanning)
+    node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* b : node.else_ifs) {
+    if (!scanning)
+      b->expr->accept(*this);
+    stmts(b->stmts);
+  }
+  if (!node.body_stmts.empty())
+    stmts(node.body_stmts);
+}
+
+
+void Optimizer::visit(WhileStmt& node)
+{
+  if (!scanning)
+    node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+
+void Optimizer::visit(ForStmt& node)
+{
+  // the loop variable gets a scope of its own
+  push_scope();
+  if (!scanning)
+    node.start->accept(*this);
+  scopes.back().push_back(nullptr);
+  if (!scanning)
+    node.end->accept(*this);
+  stmts(node.stmts);
+  pop_scope();
+}
+
+
+//----------------------------------------------------------------------
+// EXPRESSIONS
+//----------------------------------------------------------------------
+
+void Optimizer::visit(Expr& node)
+{
+  // fold the chain of left operands innermost first (in a loop, since
+  // they nest to any depth)
+  std::vector<Expr*> chain;
+  for (Expr* e = &node; e != nullptr; e = e->left_expr())
+    chain.push_back(e);
+  chain.back()->first->accept(*this);
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    Expr* e = *it;
+    unwrap(*e);
+    if (e->op) {
+      bool lhs_const = curr_const;
+      DataObject lhs_val = std::move(curr_val);
+      e->rest->accept(*this);
+      DataObject result;
+      curr_const = lhs_const and curr_const and
+        fold_binary(e->op->type(), lhs_val, curr_val, result);
+      if (curr_const)
+        curr_val = std::move(result);
+    }
+    if (e->negated and curr_const) {
+      bool val = false;
+      curr_const = curr_val.value(val);
+      curr_val.set(!val);
+    }
+    if (curr_const and (e->negated or e->op))
+      to_literal(*e);
+  }
+}
+
+
+void Optimizer::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+  // a constant call, negation, or variable becomes a literal
+  if (curr_const and !dynamic_cast<SimpleRValue*>(node.rvalue)) {
+    node.rvalue = make_literal(curr_val, node.rvalue->first_token());
+    ++fold_count;
+  }
+}
+
+
+void Optimizer::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Optimizer::visit(SimpleRValue& node)
+{
+  curr_const = literal_value(node, curr_val);
+}
+
+
+void Optimizer::visit(NewRValue&)
+{
+  curr_const = false;
+}
+
+
+void Optimizer::visit(CallExpr& node)
+{
+  std::vector<DataObject> args;
+  bool all_const = true;
+  for (Expr* e : node.arg_list) {
+    e->accept(*this);
+    all_const = all_const and curr_const;
+    args.push_back(std::move(curr_val));
+  }
+  DataObject result;
+  curr_const = all_const and
+    fold_call(node.function_id.lexeme(), args, result);
+  if (curr_const)
+    curr_val = std::move(result);
+}
+
+
+void Optimizer::visit(IDRValue& node)
+{
+  VarInfo* info = node.path.size() == 1 ? lookup(node.var) : nullptr;
+  curr_const = info and info->literal and
+    literal_value(*info->literal, curr_val);
+}
+
+
+void Optimizer::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+  if (!curr_const)
+    return;
+  if (curr_val.is_integer()) {
+    int val = 0;
+    curr_val.value(val);
+    curr_val.set(static_cast<int>(0u - static_cast<unsigned>(val)));
+  }
+  else if (curr_val.is_double()) {
+    double val = 0;
+    curr_val.value(val);
+    curr_val.set(val * (-1.0));
+  }
+  else
+    curr_const = false;
+}
+
+
+#endif
@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: output.h
+// DATE: Oct 16, 2026
+// DESC: Buffered program output for the interpreter and the VM. Text
+//       written by print is collected in a large user-space buffer and
+//       handed to the underlying stream only at flush points (a full
+//       buffer, reading input, the flush() built-in, and the end of the
+//       program), so programs that print many lines to a pipe are not
+//       slowed down by a flush per line. Interactive output (a
+//       terminal) is line buffered instead.
+//----------------------------------------------------------------------
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+
+class Output
+{
+public:
+
+  // when buffered output is handed to the stream
+  enum Mode {
+    BUFFERED,                   // when the buffer fills up
+    LINE_BUFFERED,              // after each complete line
+    UNBUFFERED                  // after every write
+  };
+
+  //----------------------------------------------------------------------
+  // Create a buffer for the given stream. Standard output is line
+  // buffered when it is a terminal and fully buffered otherwise.
+  // Inputs:
+  //   out -- the stream to write to
+  //   capacity -- the number of bytes to collect before writing
+  //----------------------------------------------------------------------
+  Output(std::ostream& out = std::cout, size_t capacity = 1 << 16);
+
+  // write any remaining output
+  ~Output();
+
+  //----------------------------------------------------------------------
+  // Change when the buffered output is written to the stream.
+  // Inputs:
+  //   mode -- the new buffering mode (pending output is kept)
+  //----------------------------------------------------------------------
+  void set_mode(Mode mode);
+
+  //----------------------------------------------------------------------
+  // Add text to the output.
+  // Inputs:
+  //   s -- the text (or character) to write
+  //----------------------------------------------------------------------
+  void write(const std::string& s);
+  void write(char c);
+
+  //----------------------------------------------------------------------
+  // Write the buffered output to the stream and flush the stream.
+  //----------------------------------------------------------------------
+  void flush();
+
+private:
+  std::ostream& out;
+  std::string buffer;
+  size_t capacity;
+  Mode mode;
+
+  // flush if the mode requires it after a write (that may have
+  // completed a line)
+  void written(bool newline);
+};
+
+
+Output::Output(std::ostream& out, size_t capacity)
+  : out(out), capacity(capacity), mode(BUFFERED)
+{
+  buffer.reserve(capacity);
+  if (&out == &std::cout and isatty(STDOUT_FILENO))
+    mode = LINE_BUFFERED;
+}
+
+
+Output::~Output()
+{
+  flush();
+}
+
+
+void Output::set_mode(Mode mode)
+{
+  this->mode = mode;
+  if (mode == UNBUFFERED)
+    flush();
+}
+
+
+void Output::write(const std::string& s)
+{
+  if (s.empty())
+    return;
+  buffer += s;
+  written(mode == LINE_BUFFERED and s.find('\n') != std::string::npos);
+}
+
+
+void Output::write(char c)
+{
+  buffer += c;
+  written(c == '\n');
+}
+
+
+void Output::written(bool newline)
+{
+  if (buffer.size() >= capacity or mode == UNBUFFERED or
+      (mode == LINE_BUFFERED and newline))
+    flush();
+}
+
+
+void Output::flush()
+{
+  if (!buffer.empty()) {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+  out.flush();
+}
+
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <vector>
 #include "token.h"
 #include "mypl_exception.h"
 #include "ast.h"
@@ -26,38 +27,42 @@ public:
 private:
   Lexer lexer;
   Token curr_token;
+  Arena* arena = nullptr;       // the program's arena (for every node)
   
   // helper functions
   void advance();
   void eat(TokenType t, std::string err_msg);
   void error(std::string err_msg);
   bool is_operator(TokenType t);
+  int precedence(TokenType t);
   bool is_val(TokenType t);
   //bool is_type(TokenType t);
   
   // recursive descent functions
   void tdecl(TypeDecl& node);
   void fdecl(FunDecl& node);
-  void vdecls(TypeDecl& node);
+  void vdecls(std::vector<VarDeclStmt*>& decls);
   void params(FunDecl& node);
   void dtype();
-  void stmts(std::list<Stmt*>& stmt_list);
-  void stmt(std::list<Stmt*>& stmt_list);
+  void stmts(Span<Stmt*>& stmt_list);
+  void stmt(std::vector<Stmt*>& stmt_list);
   void vdecl_stmt(VarDeclStmt& node);
-  void assign_stmt(AssignStmt& stmt);
-  void lvalue(std::list<Token>& tokens);
-  void cond_stmt(std::list<Stmt*>& stmt_list);
-  void condt(IfStmt& node);
-  void while_stmt(std::list<Stmt*>& stmt_list);
-  void for_stmt(std::list<Stmt*>& stmt_list);
+  void assign_stmt(AssignStmt& stmt, const Token& id);
+  void lvalue(std::vector<Token>& tokens);
+  void cond_stmt(std::vector<Stmt*>& stmt_list);
+  void condt(IfStmt& node, std::vector<BasicIf*>& else_ifs);
+  void while_stmt(std::vector<Stmt*>& stmt_list);
+  void for_stmt(std::vector<Stmt*>& stmt_list);
   void call_expr(CallExpr& node);
   void args(CallExpr& node);
-  void exit_stmt(std::list<Stmt*>& stmt_list);
+  void exit_stmt(std::vector<Stmt*>& stmt_list);
   void expr(Expr& node);
+  void binary_expr(Expr& node, int min_prec);
+  void unary_expr(Expr& node);
   void operator_();
   void rvalue(SimpleTerm& node);
   void pval();
-  void idrval(IDRValue& node);
+  void idrval(IDRValue& node, const Token& id);
 };	
 
 
@@ -100,6 +105,22 @@ bool Parser::is_operator(TokenType t)
     t == GREATER or t == LESS_EQUAL or t == GREATER_EQUAL or t == NOT_EQUAL;
 }
 
+//Binding strength of the binary operators, loosest first
+enum Precedence {OR_PREC = 1, AND_PREC, COMPARE_PREC, ADD_PREC, MULTIPLY_PREC};
+
+int Parser::precedence(TokenType t)
+{
+  if (t == OR)
+    return OR_PREC;
+  if (t == AND)
+    return AND_PREC;
+  if (t == PLUS or t == MINUS)
+    return ADD_PREC;
+  if (t == MULTIPLY or t == DIVIDE or t == MODULO)
+    return MULTIPLY_PREC;
+  return COMPARE_PREC;
+}
+
 //checks if token is a data type
 bool Parser::is_val(TokenType t)
 {
@@ -114,23 +135,27 @@ bool Parser::is_val(TokenType t)
 void Parser::parse(Program& node)
 {
   //std::cout << "[Parse]->";
+  node.source = lexer.source();
+  arena = &node.arena;
+  std::vector<Decl*> decls;
   advance();
   while (curr_token.type() != EOS) {
 	//Type Declaration  
     if (curr_token.type() == TYPE)
 	{
-	  TypeDecl* t_decl = new TypeDecl();
+	  TypeDecl* t_decl = arena->make<TypeDecl>();
       tdecl(*t_decl);
-	  node.decls.push_back(t_decl);
+	  decls.push_back(t_decl);
 	}
 	//Function Declaration 
     else
 	{
-	  FunDecl* f_decl = new FunDecl();
+	  FunDecl* f_decl = arena->make<FunDecl>();
       fdecl(*f_decl);
-	  node.decls.push_back(f_decl);
+	  decls.push_back(f_decl);
 	}
   }
+  node.decls = arena->copy(decls);
   eat(EOS, " (1) expecting end-of-file ");
   //std::cout << "PROGRAM ENDED SUCCESSFULLY" << std::endl;
 }
@@ -144,22 +169,24 @@ void Parser::tdecl(TypeDecl& node)
 	//set id to curr token and eat id
 	node.id = curr_token;
 	eat(ID, " (3) Expected token: ID ");
-  	vdecls(node);//call variable declaration
+	std::vector<VarDeclStmt*> decls;
+  	vdecls(decls);//call variable declaration
+	node.vdecls = arena->copy(decls);
   	eat(END, " (4) Expected token: END ");	  	
 }
 
 //Variable declaration
-void Parser::vdecls(TypeDecl& node)
+void Parser::vdecls(std::vector<VarDeclStmt*>& decls)
 {
 	//std::cout << "[VDecls]->";
 	if(curr_token.type() == VAR)
 	{
 		//create a v_decl, pass it through the v_decl_stmt(),
-		//then add to node and continue to vdecls()
-		VarDeclStmt* v_decls = new VarDeclStmt();
+		//then add to the list and continue to vdecls()
+		VarDeclStmt* v_decls = arena->make<VarDeclStmt>();
 		vdecl_stmt(*v_decls);
-		node.vdecls.push_back(v_decls);
-		vdecls(node);
+		decls.push_back(v_decls);
+		vdecls(decls);
 	}
 }
 
@@ -173,12 +200,11 @@ void Parser::vdecl_stmt(VarDeclStmt& node)
 	if(curr_token.type() == COLON)//Explicit Declaration
 	{
 		eat(COLON, " (26) Expected token: COLON");
-		node.type = new Token();
-		*node.type = curr_token;
+		node.type = arena->make<Token>(curr_token);
 		dtype();
 	}
 	eat(ASSIGN, " (27) Expected token: ASSIGN");
-	Expr* exprn = new Expr();
+	Expr* exprn = arena->make<Expr>();
 	expr(*exprn);//pass in expression
 	node.expr = exprn;
 }
@@ -187,7 +213,6 @@ void Parser::vdecl_stmt(VarDeclStmt& node)
 void Parser::fdecl(FunDecl& node)
 {
 	//std::cout << "[FDecl]->";
-	FunDecl* tester = new FunDecl();
   	eat(FUN, " (5) Expected token: FUN");
 	node.return_type = curr_token;
   	if(curr_token.type() == NIL)//if NIL, eat it, else check for data types
@@ -214,24 +239,26 @@ void Parser::params(FunDecl& node)
 	if(curr_token.type() == ID)
 	{
 		//Create a FunParam, obtain variables and add to node
-		FunDecl::FunParam* pms = new FunDecl::FunParam();
-		pms->id = curr_token;
+		std::vector<FunDecl::FunParam> params;
+		FunDecl::FunParam pms;
+		pms.id = curr_token;
 		eat(ID, " (11) Expected token: ID");
 		eat(COLON, " (12) Expected token: COLON");
-		pms->type = curr_token;
+		pms.type = curr_token;
 		dtype();
-		node.params.push_back(*pms);
+		params.push_back(pms);
 		while(curr_token.type() == COMMA)//List of Parameters
 		{		
-			FunDecl::FunParam* pm = new FunDecl::FunParam();
+			FunDecl::FunParam pm;
 			eat(COMMA, " (13) Expected token: COMMA");
-			pm->id = curr_token;
+			pm.id = curr_token;
 			eat(ID, " (14) Expected token: ID");
 			eat(COLON, " (15) Expected token: COLON");
-			pm->type = curr_token;
+			pm.type = curr_token;
 			dtype();
-			node.params.push_back(*pm);
+			params.push_back(pm);
 		}
+		node.params = arena->copy(params);
 	}
 }
 
@@ -256,23 +283,25 @@ void Parser::dtype()
 }
 
 //Statement->S<-
-void Parser::stmts(std::list<Stmt*>& stmt_list)
+void Parser::stmts(Span<Stmt*>& stmt_list)
 {
 	//std::cout << "[Stmts]->";
+	std::vector<Stmt*> stms;
 	while((curr_token.type() == VAR || curr_token.type() == ID) || ((curr_token.type() == IF || curr_token.type() == WHILE) || (curr_token.type() == RETURN || curr_token.type() == FOR)))
 	{
 		//Pass list to stmt()
-		stmt(stmt_list);
+		stmt(stms);
 	}
+	stmt_list = arena->copy(stms);
 }
 
 //Statement
-void Parser::stmt(std::list<Stmt*>& stmt_list)
+void Parser::stmt(std::vector<Stmt*>& stmt_list)
 {
 	//std::cout << "[Stmt]->";
 	if(curr_token.type() == VAR)//Variable Declaration Statement 
 	{
-		VarDeclStmt* stmt = new VarDeclStmt();
+		VarDeclStmt* stmt = arena->make<VarDeclStmt>();
 		vdecl_stmt(*stmt);
 		stmt_list.push_back(stmt);
 	}
@@ -294,39 +323,42 @@ void Parser::stmt(std::list<Stmt*>& stmt_list)
 	}
 	else//Other situations: 
 	{
-		//Initialize Variables
-		AssignStmt* astmt = new AssignStmt();
-		astmt->lvalue_list.push_back(curr_token);;
-		CallExpr* cxpr = new CallExpr();
-		cxpr->function_id = curr_token;
+		Token id = curr_token;
 		eat(ID, " (23) Expected token: ID");
 		//situations: 
 		if(curr_token.type() == LPAREN)//Call Expression
 		{
+			CallExpr* cxpr = arena->make<CallExpr>();
+			cxpr->function_id = id;
 			call_expr(*cxpr);
 			stmt_list.push_back(cxpr);
 		}
 		else//Assignment Statement
 		{
-			assign_stmt(*astmt);
+			AssignStmt* astmt = arena->make<AssignStmt>();
+			assign_stmt(*astmt, id);
 			stmt_list.push_back(astmt);
 		}
 	}
 }
 
 //Assignment statement
-void Parser::assign_stmt(AssignStmt& stmt)
+void Parser::assign_stmt(AssignStmt& stmt, const Token& id)
 {
 	//std::cout << "[AssignStmt]->";
-	lvalue(stmt.lvalue_list);
+	std::vector<Token> tokens(1, id);
+	lvalue(tokens);
+	stmt.lvalue_list = arena->copy(tokens);
+	//one field offset per id after the first (set by the type checker)
+	stmt.fields = arena->fill(tokens.size() - 1, -1);
 	eat(ASSIGN, " (28) Expected token: ASSIGN");
-	Expr* ex = new Expr();
+	Expr* ex = arena->make<Expr>();
 	expr(*ex);
 	stmt.expr = ex;
 }
 
 //Left value
-void Parser::lvalue(std::list<Token>& tokens)
+void Parser::lvalue(std::vector<Token>& tokens)
 {
 	//std::cout << "[LValue]->";
 	while(curr_token.type() == DOT)
@@ -338,41 +370,38 @@ void Parser::lvalue(std::list<Token>& tokens)
 }
 
 //Condition statement
-void Parser::cond_stmt(std::list<Stmt*>& stmt_list)
+void Parser::cond_stmt(std::vector<Stmt*>& stmt_list)
 {
 	//std::cout << "[CondStmt]->";
 	//Create Objects
-	IfStmt* stmt = new IfStmt();
-	BasicIf* bif = new BasicIf();
-	Expr* ex = new Expr();
-	std::list<Stmt*> stms;
+	IfStmt* stmt = arena->make<IfStmt>();
+	BasicIf* bif = arena->make<BasicIf>();
+	Expr* ex = arena->make<Expr>();
 	eat(IF, " (31) Expected token: IF");
 	//If statement condtitions
 	expr(*ex);
 	bif->expr = ex;
 	eat(THEN, " (32) Expected token: THEN");
 	//If Statement Contents
-	stmts(stms);
-	bif->stmts = stms;
+	stmts(bif->stmts);
 	stmt->if_part = bif;
-	std::list<BasicIf*> eifs;
-	stmt->else_ifs = eifs;
+	std::vector<BasicIf*> eifs;
 	//Else part
-	condt(*stmt);
+	condt(*stmt, eifs);
+	stmt->else_ifs = arena->copy(eifs);
 	stmt_list.push_back(stmt);
 	eat(END, " (33) Expected token: END");
 }
 
 //Condition
-void Parser::condt(IfStmt& node)
+void Parser::condt(IfStmt& node, std::vector<BasicIf*>& else_ifs)
 {
 	//std::cout << "[Condt]->";
 	if(curr_token.type() == ELSEIF)//Elseif Part
 	{
 		//Create Objects
-		BasicIf* bscif = new BasicIf();
-		Expr* exp = new Expr();
-		std::list<Stmt*> stm;
+		BasicIf* bscif = arena->make<BasicIf>();
+		Expr* exp = arena->make<Expr>();
 		//Else If part
 		eat(ELSEIF, " (34) Expected token: ELSEIF");
 		//conditions
@@ -380,62 +409,55 @@ void Parser::condt(IfStmt& node)
 		bscif->expr = exp;
 		eat(THEN, " (35) Expected token: THEN");
 		//statements	
-		stmts(stm);
-		bscif->stmts = stm;
-		node.else_ifs.push_back(bscif);
-		condt(node);
+		stmts(bscif->stmts);
+		else_ifs.push_back(bscif);
+		condt(node, else_ifs);
 	}
 	else if(curr_token.type() == ELSE)//Else Part
 	{
 		eat(ELSE, " (36) Expected token: ELSE");
-		std::list<Stmt*> els;
 		//contents
-		stmts(els);
-		node.body_stmts = els;
+		stmts(node.body_stmts);
 	}
 }
 
 //While statement
-void Parser::while_stmt(std::list<Stmt*>& stmt_list)
+void Parser::while_stmt(std::vector<Stmt*>& stmt_list)
 {
 	//std::cout << "[WhileStmt]->";
-	WhileStmt* stmt = new WhileStmt();//create statement list
-	std::list<Stmt*> stm;
+	WhileStmt* stmt = arena->make<WhileStmt>();//create statement list
 	eat(WHILE, " (37) Expected token: WHILE");
 	//Conditions
-	Expr* ex = new Expr();
+	Expr* ex = arena->make<Expr>();
 	expr(*ex);
 	stmt->expr = ex;
 	eat(DO, " (38) Expected token: DO");
 	//Statements in the body
-	stmts(stm);
-	stmt->stmts = stm;
+	stmts(stmt->stmts);
 	stmt_list.push_back(stmt);
 	eat(END, " (39) Expected token: END");
 }
 
 //For statement
-void Parser::for_stmt(std::list<Stmt*>& stmt_list)
+void Parser::for_stmt(std::vector<Stmt*>& stmt_list)
 {
 	//std::cout << "[ForStmt]->";
-	ForStmt* stmt = new ForStmt();
-	std::list<Stmt*> stm;
+	ForStmt* stmt = arena->make<ForStmt>();
 	eat(FOR, " (40) Expected token: FOR");
 	stmt->var_id = curr_token;
 	eat(ID, " (41) Expected token: ID");
 	eat(ASSIGN, " (42) Expected token: ASSIGN");
 	//Conditions
-	Expr* ex1 = new Expr();
+	Expr* ex1 = arena->make<Expr>();
 	expr(*ex1);
 	stmt->start = ex1;
 	eat(TO, " (43) Expected token: TO");
-	Expr* ex2 = new Expr();
+	Expr* ex2 = arena->make<Expr>();
 	expr(*ex2);
 	stmt->end = ex2;
 	eat(DO, " (44) Expected token: DO");
 	//Body Statements
-	stmts(stm);
-	stmt->stmts = stm;
+	stmts(stmt->stmts);
 	stmt_list.push_back(stmt);
 	eat(END, " (45) Expected token: END");
 }
@@ -456,26 +478,28 @@ void Parser::args(CallExpr& node)
 	//std::cout << "[ARGS]->";
 	if(((is_val(curr_token.type()) || curr_token.type() == NIL) || (curr_token.type() == NEW || curr_token.type() == ID)) || ((curr_token.type() == NEG || curr_token.type() == NOT) || (curr_token.type() == LPAREN)))
 	{
-		Expr* ex = new Expr();
+		std::vector<Expr*> arg_list;
+		Expr* ex = arena->make<Expr>();
 		expr(*ex);
-		node.arg_list.push_back(ex);
+		arg_list.push_back(ex);
 		while(curr_token.type() == COMMA)//Function call Arguments
 		{
 			eat(COMMA, " (48) Expected token: COMMA");
-			Expr* ex2 = new Expr();
+			Expr* ex2 = arena->make<Expr>();
 			expr(*ex2);	
-			node.arg_list.push_back(ex2);
+			arg_list.push_back(ex2);
 		}
+		node.arg_list = arena->copy(arg_list);
 	}
 }
 
 //Exit statement
-void Parser::exit_stmt(std::list<Stmt*>& stmt_list)
+void Parser::exit_stmt(std::vector<Stmt*>& stmt_list)
 {
 	//std::cout << "[ExitStmt]->";
 	eat(RETURN, " (49) Expected token: RETURN");
-	ReturnStmt* rs = new ReturnStmt();
-	Expr* exp = new Expr();
+	ReturnStmt* rs = arena->make<ReturnStmt>();
+	Expr* exp = arena->make<Expr>();
 	//REturn Expression
 	expr(*exp);
 	rs->expr = exp;
@@ -486,13 +510,47 @@ void Parser::exit_stmt(std::list<Stmt*>& stmt_list)
 void Parser::expr(Expr& node)
 {
 	//std::cout << "[Expr]->";
+	binary_expr(node, OR_PREC);
+}
+
+//Binary expression - precedence climbing over the operators that bind
+//at least as tightly as min_prec. Each binary node's left operand is
+//the expression built so far (nested as a ComplexTerm) and its right
+//operand binds more tightly, so operators of one level associate to
+//the left and a chain of them is a loop here rather than a recursion
+void Parser::binary_expr(Expr& node, int min_prec)
+{
+	unary_expr(node);
+	while(is_operator(curr_token.type()) && precedence(curr_token.type()) >= min_prec)
+	{
+		Token op = curr_token;
+		operator_();
+		Expr* rhs = arena->make<Expr>();
+		binary_expr(*rhs, precedence(op.type()) + 1);
+		//the expression so far becomes the left operand
+		if(node.op != nullptr || node.negated)
+		{
+			ComplexTerm* cmpt = arena->make<ComplexTerm>();
+			cmpt->expr = arena->make<Expr>(node);
+			node.negated = false;
+			node.first = cmpt;
+		}
+		node.op = arena->make<Token>(op);
+		node.rest = rhs;
+	}
+}
+
+//Unary expression - a single operand of a binary operator
+void Parser::unary_expr(Expr& node)
+{
 	if(curr_token.type() == NOT)//first term complex term (notted)
 	{
+		//not applies to the rest of the expression (as it always has)
 		eat(NOT, " (50) Expected token: NOT");
 		node.negated = true;
-		ComplexTerm* cmpt = new ComplexTerm();
-		Expr* exprn = new Expr();
-		expr(*exprn);
+		ComplexTerm* cmpt = arena->make<ComplexTerm>();
+		Expr* exprn = arena->make<Expr>();
+		binary_expr(*exprn, OR_PREC);
 		cmpt->expr = exprn;
 		node.first = cmpt;
 		
@@ -500,8 +558,8 @@ void Parser::expr(Expr& node)
 	else if(curr_token.type() == LPAREN)//first term complex term
 	{
 		eat(LPAREN, " (51) Expected token: LPAREN");
-		ComplexTerm* cmpt = new ComplexTerm();
-		Expr* exprn = new Expr();
+		ComplexTerm* cmpt = arena->make<ComplexTerm>();
+		Expr* exprn = arena->make<Expr>();
 		expr(*exprn);
 		cmpt->expr = exprn;
 		node.first = cmpt;	
@@ -509,19 +567,10 @@ void Parser::expr(Expr& node)
 	}
 	else//first term simple term
 	{
-		SimpleTerm* sptm = new SimpleTerm();
+		SimpleTerm* sptm = arena->make<SimpleTerm>();
 		rvalue(*sptm);
 		node.first = sptm;
 	}
-	if(is_operator(curr_token.type()) == true)//possible second term
-	{
-		node.op = new Token();
-		*node.op = curr_token;
-		operator_();
-		Expr* exprn = new Expr();
-		expr(*exprn);
-		node.rest = exprn;
-	}
 }
 
 //Right Value
@@ -530,14 +579,14 @@ void Parser::rvalue(SimpleTerm& node)
 	//std::cout << "[RValue]->";
 	if(is_val(curr_token.type()) == true)//Simple Right Value 
 	{
-		SimpleRValue* val = new SimpleRValue();
+		SimpleRValue* val = arena->make<SimpleRValue>();
 		val->value = curr_token;
 		pval();
 		node.rvalue = val;
 	}	
 	else if(curr_token.type() == NIL)//Nilled R Value
 	{
-		SimpleRValue* val = new SimpleRValue();
+		SimpleRValue* val = arena->make<SimpleRValue>();
 		val->value = curr_token;
 		node.rvalue = val;
 		eat(NIL, " (54) Expected token: NIL");
@@ -545,17 +594,18 @@ void Parser::rvalue(SimpleTerm& node)
 	else if(curr_token.type() == NEW)
 	{
 		eat(NEW, " (55) Expected token: NEW");//New R Value
-		NewRValue* val = new NewRValue();
+		NewRValue* val = arena->make<NewRValue>();
 		val->type_id = curr_token;
 		node.rvalue = val;
 		eat(ID, " (56) Expected token: ID");
 	}
 	else if(curr_token.type() == NEG)//Negated R Value
 	{
+		//neg applies to the next operand only
 		eat(NEG, " (57) Expected token: NEG");
-		NegatedRValue* val = new NegatedRValue();
-		Expr* exprn = new Expr();
-		expr(*exprn);
+		NegatedRValue* val = arena->make<NegatedRValue>();
+		Expr* exprn = arena->make<Expr>();
+		unary_expr(*exprn);
 		val->expr = exprn;
 		node.rvalue = val;
 	}
@@ -565,16 +615,15 @@ void Parser::rvalue(SimpleTerm& node)
 		eat(ID, " (58) Expected token: ID ");
 		if(curr_token.type() == LPAREN)//Call Expression
 		{
-			CallExpr* cexpr = new CallExpr();
+			CallExpr* cexpr = arena->make<CallExpr>();
 			cexpr->function_id = tmp_id;
 			call_expr(*cexpr);
 			node.rvalue = cexpr;
 		}
 		else//ID Right Value
 		{
-			IDRValue* idv = new IDRValue();
-			idv->path.push_back(tmp_id);
-			idrval(*idv);
+			IDRValue* idv = arena->make<IDRValue>();
+			idrval(*idv, tmp_id);
 			node.rvalue = idv;
 		}	
 	}
@@ -633,15 +682,19 @@ void Parser::pval()
 }
 
 //Right ID Value
-void Parser::idrval(IDRValue& node)
+void Parser::idrval(IDRValue& node, const Token& id)
 {
 	//std::cout << "[IDRValue]->";
+	std::vector<Token> path(1, id);
 	while(curr_token.type() == DOT)
 	{
 		eat(DOT, " (65) Expected token: DOT");
-		node.path.push_back(curr_token);
+		path.push_back(curr_token);
 		eat(ID, " (66) Expected token: ID");
 	}
+	node.path = arena->copy(path);
+	//one field offset per id after the first (set by the type checker)
+	node.fields = arena->fill(path.size() - 1, -1);
 }
 
 #endif
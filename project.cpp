@@ -6,43 +6,199 @@
 //----------------------------------------------------------------------
 
 #include <iostream>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
+#include <vector>
 #include "token.h"
 #include "mypl_exception.h"
 #include "lexer.h"
 #include "parser.h"
 #include "ast.h"
-#include "type_checker.h"
+#include "front_end.h"
 #include "interpreter.h"
+#include "compiler.h"
+#include "vm.h"
+#include "ast_cache.h"
 
 using namespace std;
 
 
+// lex, parse, type check, resolve the variables of, and (unless
+// optimize is false) optimize the program read by the given lexer,
+// inlining functions of up to inline_budget nodes and type checking
+// function bodies on the given number of threads
+void check(const Lexer& lexer, Program& ast_root_node, bool optimize = true,
+           int inline_budget = DEFAULT_INLINE_BUDGET, unsigned threads = 1)
+{
+  Parser parser(lexer);
+  parser.parse(ast_root_node);
+  check_program(ast_root_node, optimize, inline_budget, threads);
+}
+
+
+// check the program in the given source, or load it already checked
+// from the ast cache (adding it to the cache on a miss), type checking
+// function bodies on the given number of threads
+void check_cached(shared_ptr<SourceBuffer> source, Program& ast_root_node,
+                  unsigned threads = 1)
+{
+  string cache_file = ast_cache_path(*source);
+  if (!cache_file.empty() and load_ast_cache(cache_file, *source, ast_root_node))
+    return;
+  check(Lexer(source), ast_root_node, true, DEFAULT_INLINE_BUDGET, threads);
+  if (!cache_file.empty())
+    save_ast_cache(ast_root_node, *source, cache_file);
+}
+
+
+// run a checked program with the ast interpreter ("-ast") or by
+// compiling it to bytecode ("-vm"), returning the return code (and
+// optionally reporting garbage collection statistics on stderr)
+int run(Program& ast_root_node, const string& mode, bool prompt_debugger,
+        bool gc_stats = false)
+{
+  if (mode == "-ast") {
+    Interpreter interpreter(prompt_debugger);
+    ast_root_node.accept(interpreter);
+    if (gc_stats)
+      cerr << interpreter.gc_stats() << endl;
+    return interpreter.return_code();
+  }
+  Module module;
+  Compiler compiler(module);
+  ast_root_node.accept(compiler);
+  VM vm(module);
+  vm.run();
+  if (gc_stats)
+    cerr << vm.gc_stats() << endl;
+  return vm.return_code();
+}
+
+
+// run the program in the given file, capturing all output (including
+// errors) and feeding it the given input (checking it with the given
+// options)
+string capture(const string& file_name, const string& mode, const string& input,
+               bool optimize, int inline_budget, unsigned threads)
+{
+  Lexer lexer(make_shared<SourceBuffer>(file_name));
+  istringstream in(input);
+  ostringstream out;
+  streambuf* cin_buf = cin.rdbuf(in.rdbuf());
+  streambuf* cout_buf = cout.rdbuf(out.rdbuf());
+  try {
+    Program ast_root_node;
+    check(lexer, ast_root_node, optimize, inline_budget, threads);
+    run(ast_root_node, mode, false);
+  } catch (MyPLException e) {
+    cout << e.to_string() << endl;
+  } catch (exception& e) {
+    cout << "Error: " << e.what() << endl;
+  }
+  cin.rdbuf(cin_buf);
+  cout.rdbuf(cout_buf);
+  return out.str();
+}
+
+
+// run each file with both the ast interpreter and the vm (checked with
+// the given options) and compare their output, returning the number of
+// files that differ
+int diff(const vector<string>& file_names, bool optimize, int inline_budget,
+         unsigned threads)
+{
+  // every run gets the same standard input
+  ostringstream input;
+  if (!file_names.empty())
+    input << cin.rdbuf();
+  int failed = 0;
+  for (const string& file_name : file_names) {
+    string ast_out = capture(file_name, "-ast", input.str(), optimize,
+                             inline_budget, threads);
+    string vm_out = capture(file_name, "-vm", input.str(), optimize,
+                            inline_budget, threads);
+    if (ast_out == vm_out) {
+      cout << "PASS " << file_name << endl;
+      continue;
+    }
+    ++failed;
+    cout << "FAIL " << file_name << endl;
+    // report the first line that differs
+    istringstream ast_lines(ast_out), vm_lines(vm_out);
+    string ast_line, vm_line;
+    int line = 1;
+    while (getline(ast_lines, ast_line) and getline(vm_lines, vm_line) and
+           ast_line == vm_line)
+      ++line;
+    cout << "  line " << line << " ast: " << ast_line << endl;
+    cout << "  line " << line << " vm:  " << vm_line << endl;
+  }
+  cout << file_names.size() - failed << " of " << file_names.size()
+       << " programs match" << endl;
+  return failed;
+}
+
+
 int main(int argc, char* argv[])
 {
-  // use standard input if no input file given
-  istream* input_stream = &cin;
-  if (argc == 2)
-    input_stream = new ifstream(argv[1]);
+  // usage: mypl [-vm | -ast | -diff] [-gc] [-nocache] [-noopt]
+  //             [-inline n] [-threads n] [file ...]
+  // where -vm (the default) runs the bytecode vm, -ast runs the ast
+  // interpreter (with the debugger), -diff runs both over each file,
+  // -gc reports garbage collection statistics, -nocache always checks
+  // the program instead of using the ast cache, and -noopt runs the
+  // program without optimizing it (cached programs are optimized, so
+  // -noopt implies -nocache), and -inline n inlines functions of up to
+  // n nodes (a budget other than the default also bypasses the cache),
+  // and -threads n type checks function bodies concurrently on n
+  // threads
+  string mode = "-vm";
+  bool gc_stats = false;
+  bool use_cache = true;
+  bool optimize = true;
+  int inline_budget = DEFAULT_INLINE_BUDGET;
+  unsigned threads = 1;
+  vector<string> file_names;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-vm" or arg == "-ast" or arg == "-diff")
+      mode = arg;
+    else if (arg == "-gc")
+      gc_stats = true;
+    else if (arg == "-nocache")
+      use_cache = false;
+    else if (arg == "-noopt")
+      optimize = false;
+    else if (arg == "-inline" and i + 1 < argc)
+      inline_budget = atoi(argv[++i]);
+    else if (arg == "-threads" and i + 1 < argc)
+      threads = max(atoi(argv[++i]), 1);
+    else
+      file_names.push_back(arg);
+  }
+  if (mode == "-diff")
+    return diff(file_names, optimize, inline_budget, threads) == 0 ? 0 : 1;
 
-  // create the lexer
-  Lexer lexer(*input_stream);
-  Parser parser(lexer);
-  // read each token in the file until EOS or error
-  Interpreter interpreter;
+  // use standard input if no input file given (a file is mapped into
+  // memory instead of being read)
+  shared_ptr<SourceBuffer> source;
+  if (file_names.size() == 1)
+    source = make_shared<SourceBuffer>(file_names[0]);
+  else
+    source = make_shared<SourceBuffer>(cin);
+
+  int ret_code = 0;
   try {
     Program ast_root_node;
-    parser.parse(ast_root_node);
-    TypeChecker type_checker;
-    ast_root_node.accept(type_checker);
-    ast_root_node.accept(interpreter);
+    if (use_cache and optimize and inline_budget == DEFAULT_INLINE_BUDGET)
+      check_cached(source, ast_root_node, threads);
+    else
+      check(Lexer(source), ast_root_node, optimize, inline_budget, threads);
+    ret_code = run(ast_root_node, mode, true, gc_stats);
   } catch (MyPLException e) {
     cout << e.to_string() << endl;
     exit(1);
   }
-  // clean up the input stream
-  if (input_stream != &cin)
-    delete input_stream;
-  return interpreter.return_code();
+  return ret_code;
 }
-
@@ -0,0 +1,323 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: resolver.h
+// DATE: Oct 16, 2026
+// DESC: Resolves every variable use and declaration of a type-checked
+//       AST to a (depth, slot) pair. The resolver opens a scope at
+//       exactly the points where the interpreter pushes one at
+//       runtime (function bodies, if/while/for bodies, the for-loop
+//       variable, and new objects), so the interpreter can find a
+//       variable by index without looking up its name. It also marks
+//       the calls in tail position (those whose value, if any, is the
+//       calling function's result), which run in the caller's frame.
+//----------------------------------------------------------------------
+
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ast.h"
+
+
+class Resolver : public Visitor
+{
+public:
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+
+private:
+
+  // the variable names declared in each open scope (in slot order)
+  std::vector<std::vector<std::string>> scopes;
+
+  // the user-defined functions
+  std::unordered_map<std::string, FunDecl*> functions;
+
+  // scope helpers
+  void push_scope();
+  void pop_scope();
+  void declare(const Token& id, VarSlot& var);
+  void resolve(const Token& id, VarSlot& var);
+  void stmts(Span<Stmt*>& stmt_list);
+
+  // tail call helpers
+  CallExpr* user_call(Expr* expr);
+  void mark_final_calls(Span<Stmt*>& stmt_list);
+
+  // error message
+  void error(const std::string& msg, const Token& token);
+};
+
+
+void Resolver::error(const std::string& msg, const Token& token)
+{
+  throw MyPLException(SEMANTIC, msg, token.line(), token.column());
+}
+
+
+//----------------------------------------------------------------------
+// HELPER FUNCTIONS
+//----------------------------------------------------------------------
+
+void Resolver::push_scope()
+{
+  scopes.push_back(std::vector<std::string>());
+}
+
+
+void Resolver::pop_scope()
+{
+  scopes.pop_back();
+}
+
+
+// add the name to the current scope (a redeclaration gets a new slot
+// that shadows the previous one)
+void Resolver::declare(const Token& id, VarSlot& var)
+{
+  var.depth = 0;
+  var.slot = scopes.back().size();
+  scopes.back().push_back(id.lexeme());
+}
+
+
+// find the most recent declaration of the name
+void Resolver::resolve(const Token& id, VarSlot& var)
+{
+  for (size_t depth = 0; depth < scopes.size(); ++depth) {
+    std::vector<std::string>& names = scopes[scopes.size() - 1 - depth];
+    for (size_t slot = names.size(); slot > 0; --slot) {
+      if (names[slot-1] == id.lexeme()) {
+        var.depth = depth;
+        var.slot = slot - 1;
+        return;
+      }
+    }
+  }
+  error("undefined variable '" + id.lexeme() + "'", id);
+}
+
+
+void Resolver::stmts(Span<Stmt*>& stmt_list)
+{
+  push_scope();
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+  pop_scope();
+}
+
+
+// the call if the expression is just a call of a user-defined function
+CallExpr* Resolver::user_call(Expr* expr)
+{
+  if (expr->negated or expr->op)
+    return nullptr;
+  SimpleTerm* term = dynamic_cast<SimpleTerm*>(expr->first);
+  CallExpr* call = term ? dynamic_cast<CallExpr*>(term->rvalue) : nullptr;
+  if (!call or !functions.count(call->function_id.lexeme()))
+    return nullptr;
+  return call;
+}
+
+
+// mark a call of a nil function that is the last statement executed
+// (in a nil function, where falling off the end returns nil anyway)
+void Resolver::mark_final_calls(Span<Stmt*>& stmt_list)
+{
+  if (stmt_list.empty())
+    return;
+  Stmt* last = stmt_list[stmt_list.size() - 1];
+  if (IfStmt* if_stmt = dynamic_cast<IfStmt*>(last)) {
+    mark_final_calls(if_stmt->if_part->stmts);
+    for (BasicIf* b : if_stmt->else_ifs)
+      mark_final_calls(b->stmts);
+    mark_final_calls(if_stmt->body_stmts);
+  }
+  else if (CallExpr* call = dynamic_cast<CallExpr*>(last)) {
+    auto it = functions.find(call->function_id.lexeme());
+    if (it != functions.end() and it->second->return_type.type() == NIL)
+      call->tail = true;
+  }
+}
+
+
+//----------------------------------------------------------------------
+// TOP-LEVEL
+//----------------------------------------------------------------------
+
+void Resolver::visit(Program& node)
+{
+  for (Decl* d : node.decls)
+    if (FunDecl* f = dynamic_cast<FunDecl*>(d))
+      functions.insert({f->id.lexeme(), f});
+  for (Decl* d : node.decls)
+    d->accept(*this);
+}
+
+
+void Resolver::visit(FunDecl& node)
+{
+  // parameters take the first slots of the function's scope, and the
+  // body shares that scope
+  push_scope();
+  for (FunDecl::FunParam& param : node.params)
+    scopes.back().push_back(param.id.lexeme());
+  for (Stmt* s : node.stmts)
+    s->accept(*this);
+  pop_scope();
+  if (node.return_type.type() == NIL)
+    mark_final_calls(node.stmts);
+}
+
+
+void Resolver::visit(TypeDecl& node)
+{
+  // field initializers run in a scope of their own
+  push_scope();
+  for (VarDeclStmt* v : node.vdecls)
+    v->accept(*this);
+  pop_scope();
+}
+
+
+//----------------------------------------------------------------------
+// STATEMENTS
+//----------------------------------------------------------------------
+
+void Resolver::visit(VarDeclStmt& node)
+{
+  node.expr->accept(*this);
+  declare(node.id, node.var);
+}
+
+
+void Resolver::visit(AssignStmt& node)
+{
+  resolve(node.lvalue_list.front(), node.var);
+  node.expr->accept(*this);
+}
+
+
+void Resolver::visit(ReturnStmt& node)
+{
+  node.expr->accept(*this);
+  if (CallExpr* call = user_call(node.expr))
+    call->tail = true;
+}
+
+
+void Resolver::visit(IfStmt& node)
+{
+  node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* b : node.else_ifs) {
+    b->expr->accept(*this);
+    stmts(b->stmts);
+  }
+  if (!node.body_stmts.empty())
+    stmts(node.body_stmts);
+}
+
+
+void Resolver::visit(WhileStmt& node)
+{
+  node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+
+void Resolver::visit(ForStmt& node)
+{
+  // the loop variable gets a scope of its own (which the start
+  // expression is also evaluated in)
+  push_scope();
+  node.start->accept(*this);
+  declare(node.var_id, node.var);
+  node.end->accept(*this);
+  stmts(node.stmts);
+  pop_scope();
+}
+
+
+//----------------------------------------------------------------------
+// EXPRESSIONS
+//----------------------------------------------------------------------
+
+void Resolver::visit(Expr& node)
+{
+  // walk the chain of left operands in a loop (they nest to any depth)
+  Expr* e = &node;
+  while (Expr* left = e->left_expr()) {
+    e->rest->accept(*this);
+    e = left;
+  }
+  e->first->accept(*this);
+  if (e->rest)
+    e->rest->accept(*this);
+}
+
+
+void Resolver::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+}
+
+
+void Resolver::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+void Resolver::visit(SimpleRValue&)
+{
+}
+
+
+void Resolver::visit(NewRValue&)
+{
+}
+
+
+void Resolver::visit(CallExpr& node)
+{
+  for (Expr* e : node.arg_list)
+    e->accept(*this);
+}
+
+
+void Resolver::visit(IDRValue& node)
+{
+  resolve(node.path.front(), node.var);
+}
+
+
+void Resolver::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+}
+
+
+#endif
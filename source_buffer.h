@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: source_buffer.h
+// DATE: Oct 16, 2026
+// DESC: The complete text of a MyPL program in one contiguous block of
+//       memory. A file is memory-mapped (read only) and any other
+//       stream is read fully into an owned buffer, so the lexer can
+//       scan raw bytes and tokens can refer to their lexemes as spans
+//       of the buffer instead of copies.
+//----------------------------------------------------------------------
+
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <istream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+class SourceBuffer
+{
+public:
+
+  //----------------------------------------------------------------------
+  // Memory-map the given file (anything that is not a regular file,
+  // such as a pipe, is read instead). A file that cannot be opened
+  // gives an empty buffer, just like reading from a failed stream
+  // would.
+  // Inputs:
+  //   file_name -- the path of the source file
+  //----------------------------------------------------------------------
+  SourceBuffer(const std::string& file_name);
+
+  //----------------------------------------------------------------------
+  // Read the rest of the stream into the buffer (used for standard
+  // input and in-memory sources).
+  // Inputs:
+  //   input_stream -- the stream to read
+  //----------------------------------------------------------------------
+  SourceBuffer(std::istream& input_stream);
+
+  // unmap the file (if mapped)
+  ~SourceBuffer();
+
+  // tokens point into the buffer, so it is never copied
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+  // the first byte of the source and one past its last byte
+  const char* begin() const;
+  const char* end() const;
+
+  // the number of bytes in the source
+  size_t size() const;
+
+private:
+
+  // the mapped file (mapped is null when the source is in text)
+  void* mapped;
+  size_t mapped_size;
+  std::string text;
+};
+
+
+SourceBuffer::SourceBuffer(const std::string& file_name)
+  : mapped(nullptr), mapped_size(0)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat info;
+  if (fstat(fd, &info) == 0 and S_ISREG(info.st_mode)) {
+    if (info.st_size > 0) {
+      void* p = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        mapped = p;
+        mapped_size = info.st_size;
+        madvise(mapped, mapped_size, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+    if (mapped or info.st_size == 0)
+      return;
+  }
+  else
+    close(fd);
+  std::ifstream input_stream(file_name);
+  text.assign(std::istreambuf_iterator<char>(input_stream),
+              std::istreambuf_iterator<char>());
+}
+
+
+SourceBuffer::SourceBuffer(std::istream& input_stream)
+  : mapped(nullptr), mapped_size(0),
+    text(std::istreambuf_iterator<char>(input_stream),
+         std::istreambuf_iterator<char>())
+{
+}
+
+
+SourceBuffer::~SourceBuffer()
+{
+  if (mapped)
+    munmap(mapped, mapped_size);
+}
+
+
+const char* SourceBuffer::begin() const
+{
+  return mapped ? static_cast<const char*>(mapped) : text.data();
+}
+
+
+const char* SourceBuffer::end() const
+{
+  return begin() + size();
+}
+
+
+size_t SourceBuffer::size() const
+{
+  return mapped ? mapped_size : text.size();
+}
+
+
+#endif
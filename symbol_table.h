@@ -2,14 +2,28 @@
 // NAME: S. Bowers
 // FILE: symbol_table.h
 // DATE: Spring 2021
-// DESC: Basic symbol table implementation for type checking.
+// DESC: Basic symbol table implementation for type checking. The open
+//       environments form one stack: their names live in a single
+//       contiguous vector of slots (each environment's slots follow
+//       its parent's), so pushing an environment is O(1) and popping
+//       one is O(names it declared). Each name also maps to its
+//       innermost slot, and each slot links to the slot it shadows,
+//       so a lookup is one hash probe instead of a search of every
+//       environment. A name declared again in the same environment
+//       also takes a new slot (shadowing the old one), so the names
+//       visible after any number of declarations are those of the
+//       slots below that number. A table can also be opened over a
+//       read-only parent table (such as a filled-in global
+//       environment), seeing the parent's first names beneath its own.
 //----------------------------------------------------------------------
 
 
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 
+#include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <list>
 #include "data_object.h"
@@ -25,7 +39,16 @@ class SymbolTable
 {
 public:
 
-  ~SymbolTable();
+  // the kind of info stored for a name (UNDEFINED if the name does not
+  // exist, NONE if its info has not been set)
+  enum InfoType {UNDEFINED, NONE, STR, MAP, VEC, VAL};
+
+  // create a symbol table, optionally over a parent table whose first
+  // parent_names names (see name_count) are visible, but cannot be
+  // set, from this one. The parent must not change while this table
+  // is in use.
+  SymbolTable(const SymbolTable* parent = nullptr, size_t parent_names = 0)
+    : parent(parent), parent_names(parent_names) {}
 
   // add a new environment to the environment stack
   void push_environment();
@@ -36,8 +59,8 @@ public:
   // get the current environment identifier
   int get_environment_id();
 
-  // set the current environment to the given environment identifier
-  void set_environment_id(int env_id);
+  // get the number of names declared in the open environments
+  size_t name_count() const;
 
   // add given name to the current environment
   void add_name(const std::string& name);
@@ -48,7 +71,7 @@ public:
   // check if name exists in current environment
   bool name_exists_in_curr_env(const std::string& name) const;
 
-  // check if name exists in given environment
+  // check if name exists in given (open) environment
   bool name_exists_in_env(const std::string& name, int env_id) const;
 
   // set the name's symbol-table info (as a string)
@@ -62,19 +85,19 @@ public:
 
   // set the nane's symbol-table info (as a vector of string)
   void set_vec_info(const std::string& name, const StringVec& info);
-  
+
   // returns true if the name exists and has string information
   bool has_str_info(const std::string& name) const;
 
   // returns true if the name exists and has data-object information
   bool has_val_info(const std::string& name) const;
-  
+
   // returns true if the name exists and has map information
   bool has_map_info(const std::string& name) const;
 
   // returns true if the name exists and has vector information
   bool has_vec_info(const std::string& name) const;
-  
+
   // get the name's symbol-table info (if stored as a string)
   void get_str_info(const std::string& name, std::string& info) const;
 
@@ -86,64 +109,78 @@ public:
 
   // get the name's symbol-table info (if stored as a map)
   void get_vec_info(const std::string& name, StringVec& info) const;
-  
+
+  // look up the name once and return the kind of info it has
+  InfoType info_type(const std::string& name) const;
+
+  // get a pointer to the name's symbol-table info without copying it
+  // (null if the name does not exist or its info is of another kind).
+  // The pointer is valid until the next name is added, the name's
+  // info is set, or its environment is popped.
+  const std::string* str_info(const std::string& name) const;
+  const DataObject* val_info(const std::string& name) const;
+  const StringMap* map_info(const std::string& name) const;
+  const StringVec* vec_info(const std::string& name) const;
+
   // give a string representation for printing/testing
   std::string to_string() const;
-  
+
 private:
 
-  // a generic object for storing multiple types within the symbol table
-  enum Type {STR, MAP, VEC, VAL};
-  struct SymTableObject {
-    virtual Type type() = 0;
-  };
-  struct StrObject : SymTableObject
-  {
+  // a name declared in an environment, its info, and the slot of the
+  // declaration it shadows (-1 if none). The info is stored in place
+  // by type, so setting it again reuses the slot's payload instead of
+  // allocating a new one.
+  struct Slot {
+    std::string name;
+    int shadowed;
+    InfoType type = NONE;
     std::string str_val;
-    Type type() {return STR;};
-  };
-  struct ValObject : SymTableObject
-  {
     DataObject obj_val;
-    Type type() {return VAL;};
-  };
-  struct MapObject : SymTableObject
-  {
     StringMap map_val;
-    Type type() {return MAP;};
-  };
-  // a vector object
-  struct VecObject : SymTableObject
-  {
     StringVec vec_val;
-    Type type() {return VEC;};
   };
-  
-  // an environment is a string to object mapping
-  typedef std::map<std::string,SymTableObject*> Environment;
 
-  // a symbol table is a stack of environment id, environment pairs
-  typedef std::vector<std::pair<int,Environment>> EnvironmentList;
+  // the slots of every open environment, outermost first
+  std::vector<Slot> slots;
 
-  // the list of environments
-  EnvironmentList environments;
+  // the index of each open environment's first slot, and its id
+  std::vector<size_t> env_base;
+  std::vector<int> env_ids;
+
+  // the slot of each name's innermost declaration
+  std::unordered_map<std::string,int> innermost;
 
   // environment counter (for assignment environment ids
   int environment_count = 0;
-  
-  // holds the current environment identifier
-  int current_environment_id = 0;
 
-  // gets the current environment index 
-  int curr_env_index() const;
+  // the table whose first names are visible beneath this one's (or
+  // null), and the number of its names visible
+  const SymbolTable* parent;
+  size_t parent_names;
+
+  // get the slot of the name in the current or an ancestor
+  // environment (-1 if there is none)
+  int find_slot(const std::string& name) const;
+
+  // get the name's slot in this table or, failing that, the parent
+  // (null if there is none)
+  const Slot* find(const std::string& name) const;
+
+  // get the name's innermost slot among the first names of this table
+  // (null if there is none)
+  const Slot* find_before(const std::string& name, size_t names) const;
+
+  // get the name's slot if its info is of the given type (else null)
+  const Slot* typed_slot(const std::string& name, InfoType type) const;
+
+  // get the name's slot, switching its info to the given type
+  // (null if the name does not exist)
+  Slot* info_slot(const std::string& name, InfoType type);
 
-  // get environment index containing the given name, starting from
-  // current environment and moving up the stack of environments
-  bool get_env_for_name(const std::string& name, int& index) const;
+  // release the slot's info (keeping the name)
+  void clear_info(Slot& slot);
 
-  // delete appropriate symbol table object (based on type)
-  void delete_sym_obj(SymTableObject* obj);
-  
 };
 
 
@@ -151,74 +188,63 @@ private:
 // BASIC SYMBOL TABLE OPERATIONS
 //----------------------------------------------------------------------
 
-SymbolTable::~SymbolTable()
-{
-  for (std::pair<int,Environment> p1 : environments) {
-    for (std::pair<std::string,SymTableObject*> p2 : p1.second)
-      delete_sym_obj(p2.second);
-    p1.second.clear();
-  }
-  environments.clear();
-}
-
-
 void SymbolTable::push_environment()
 {
-  std::pair<int,Environment> env_entry;
-  env_entry.first = environment_count++;
-  auto it = environments.begin();
-  // insert as first or from current environment
-  if (environments.size() == 0)
-    environments.insert(it, env_entry);
-  else
-    environments.insert(it + curr_env_index() + 1, env_entry);
-  current_environment_id = env_entry.first;
+  env_base.push_back(slots.size());
+  env_ids.push_back(environment_count++);
 }
 
 
 void SymbolTable::pop_environment()
 {
-  if (environments.size() == 0)
+  if (env_base.empty())
     return;
-  int index = curr_env_index();
-  // clean up environment
-  for (std::pair<std::string,SymTableObject*> m : environments[index].second)
-    delete_sym_obj(m.second);
-  // remove the environment
-  environments.erase(environments.begin() + index);
-  if (index > 0)
-    current_environment_id = environments[index-1].first;
-  else
-    current_environment_id = -1;
+  // drop the environment's slots, uncovering the names they shadowed
+  while (slots.size() > env_base.back()) {
+    Slot& slot = slots.back();
+    if (slot.shadowed == -1)
+      innermost.erase(slot.name);
+    else
+      innermost[slot.name] = slot.shadowed;
+    slots.pop_back();
+  }
+  env_base.pop_back();
+  env_ids.pop_back();
 }
 
 
 int SymbolTable::get_environment_id()
 {
-  return current_environment_id;
+  return env_ids.empty() ? -1 : env_ids.back();
 }
 
 
-void SymbolTable::set_environment_id(int env_id)
+size_t SymbolTable::name_count() const
 {
-  current_environment_id = env_id;
+  return slots.size();
 }
 
-  
+
 void SymbolTable::add_name(const std::string& name)
 {
-  if (environments.size() == 0)
+  if (env_base.empty())
     return;
-  environments[curr_env_index()].second[name] = nullptr;
+  int slot = slots.size();
+  auto entry = innermost.emplace(name, slot);
+  int shadowed = -1;
+  if (!entry.second) {
+    shadowed = entry.first->second;
+    entry.first->second = slot;
+  }
+  slots.emplace_back();
+  slots.back().name = name;
+  slots.back().shadowed = shadowed;
 }
 
 
 bool SymbolTable::name_exists(const std::string& name) const
 {
-  if (environments.size() == 0)
-    return false;
-  int index = 0;
-  return get_env_for_name(name, index);
+  return find(name) != nullptr;
 }
 
 //----------------------------------------------------------------------
@@ -227,53 +253,33 @@ bool SymbolTable::name_exists(const std::string& name) const
 
 void SymbolTable::set_str_info(const std::string& name, const std::string& info)
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    StrObject* obj = new StrObject;
-    obj->str_val = info;
-    if (environments[index].second[name])
-      delete_sym_obj(environments[index].second[name]);
-    environments[index].second[name] = obj;
-  }
+  Slot* slot = info_slot(name, STR);
+  if (slot)
+    slot->str_val = info;
 }
 
 
 void SymbolTable::set_val_info(const std::string& name, const DataObject& info)
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    ValObject* obj = new ValObject;
-    obj->obj_val = info;
-    if (environments[index].second[name])
-      delete_sym_obj(environments[index].second[name]);
-    environments[index].second[name] = obj;
-  }
+  Slot* slot = info_slot(name, VAL);
+  if (slot)
+    slot->obj_val = info;
 }
 
 
 void SymbolTable::set_vec_info(const std::string& name, const StringVec& info)
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    VecObject* obj = new VecObject;
-    obj->vec_val = info;
-    if (environments[index].second[name])
-      delete_sym_obj(environments[index].second[name]);
-    environments[index].second[name] = obj;
-  }
+  Slot* slot = info_slot(name, VEC);
+  if (slot)
+    slot->vec_val = info;
 }
 
 
 void SymbolTable::set_map_info(const std::string& name, const StringMap& info)
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    MapObject* obj = new MapObject;
-    obj->map_val = info;
-    if (environments[index].second[name])
-      delete_sym_obj(environments[index].second[name]);
-    environments[index].second[name] = obj;
-  }
+  Slot* slot = info_slot(name, MAP);
+  if (slot)
+    slot->map_val = info;
 }
 
 
@@ -283,45 +289,25 @@ void SymbolTable::set_map_info(const std::string& name, const StringMap& info)
 
 bool SymbolTable::has_str_info(const std::string& name) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    return obj and obj->type() == STR;
-  }
-  return false;
+  return typed_slot(name, STR) != nullptr;
 }
 
 
 bool SymbolTable::has_val_info(const std::string& name) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    return obj and obj->type() == VAL;
-  }
-  return false;
+  return typed_slot(name, VAL) != nullptr;
 }
-  
+
 
 bool SymbolTable::has_vec_info(const std::string& name) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    return obj and obj->type() == VEC;
-  }
-  return false;
+  return typed_slot(name, VEC) != nullptr;
 }
 
 
 bool SymbolTable::has_map_info(const std::string& name) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    return obj and obj->type() == MAP;
-  }
-  return false;
+  return typed_slot(name, MAP) != nullptr;
 }
 
 
@@ -331,45 +317,72 @@ bool SymbolTable::has_map_info(const std::string& name) const
 
 void SymbolTable::get_str_info(const std::string& name, std::string& info) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    if (obj)
-      info = ((StrObject*)obj)->str_val;
-  }
+  const Slot* slot = typed_slot(name, STR);
+  if (slot)
+    info = slot->str_val;
 }
 
 
 void SymbolTable::get_val_info(const std::string& name, DataObject& info) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    if (obj) 
-      info = ((ValObject*)obj)->obj_val;
-  }
+  const Slot* slot = typed_slot(name, VAL);
+  if (slot)
+    info = slot->obj_val;
 }
 
 
 void SymbolTable::get_vec_info(const std::string& name, StringVec& info) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    if (obj)
-      info = ((VecObject*)obj)->vec_val;
-  }
+  const Slot* slot = typed_slot(name, VEC);
+  if (slot)
+    info = slot->vec_val;
 }
 
 
 void SymbolTable::get_map_info(const std::string& name, StringMap& info) const
 {
-  int index = -1;
-  if (get_env_for_name(name, index)) {
-    SymTableObject* obj = environments[index].second.at(name);
-    if (obj)
-      info = ((MapObject*)obj)->map_val;
-  }
+  const Slot* slot = typed_slot(name, MAP);
+  if (slot)
+    info = slot->map_val;
+}
+
+
+//----------------------------------------------------------------------
+// IN-PLACE INFO ACCESS
+//----------------------------------------------------------------------
+
+SymbolTable::InfoType SymbolTable::info_type(const std::string& name) const
+{
+  const Slot* slot = find(name);
+  return slot ? slot->type : UNDEFINED;
+}
+
+
+const std::string* SymbolTable::str_info(const std::string& name) const
+{
+  const Slot* slot = typed_slot(name, STR);
+  return slot ? &slot->str_val : nullptr;
+}
+
+
+const DataObject* SymbolTable::val_info(const std::string& name) const
+{
+  const Slot* slot = typed_slot(name, VAL);
+  return slot ? &slot->obj_val : nullptr;
+}
+
+
+const StringMap* SymbolTable::map_info(const std::string& name) const
+{
+  const Slot* slot = typed_slot(name, MAP);
+  return slot ? &slot->map_val : nullptr;
+}
+
+
+const StringVec* SymbolTable::vec_info(const std::string& name) const
+{
+  const Slot* slot = typed_slot(name, VEC);
+  return slot ? &slot->vec_val : nullptr;
 }
 
 
@@ -380,18 +393,20 @@ void SymbolTable::get_map_info(const std::string& name, StringMap& info) const
 std::string SymbolTable::to_string() const
 {
   std::string s = "";
-  for (std::pair<int,Environment> env_entry : environments) {
-    s += "environment " + std::to_string(env_entry.first) + ": \n";
-    for (std::pair<std::string,SymTableObject*> p : env_entry.second) {
-      s += "  name '" + p.first + "' has-info ";
-      if (p.second) {
-        if (p.second->type() == STR)
-          s += "STR '" + ((StrObject*)p.second)->str_val + "'";
-        if (p.second->type() == VAL)
-          s += "VAL '" + ((ValObject*)p.second)->obj_val.to_string() + "'";
-        else if (p.second->type() == VEC) {
+  for (size_t env = 0; env < env_base.size(); ++env) {
+    s += "environment " + std::to_string(env_ids[env]) + ": \n";
+    size_t end = env + 1 < env_base.size() ? env_base[env+1] : slots.size();
+    for (size_t k = env_base[env]; k < end; ++k) {
+      const Slot& p = slots[k];
+      s += "  name '" + p.name + "' has-info ";
+      if (p.type != NONE) {
+        if (p.type == STR)
+          s += "STR '" + p.str_val + "'";
+        if (p.type == VAL)
+          s += "VAL '" + p.obj_val.to_string() + "'";
+        else if (p.type == VEC) {
           s += "StringVec {";
-          StringVec vec = ((VecObject*)p.second)->vec_val;
+          const StringVec& vec = p.vec_val;
           int i = 0;
           for (std::string val : vec) {
             s += "'" + val + "'";
@@ -401,9 +416,9 @@ std::string SymbolTable::to_string() const
           }
           s += "}";
         }
-        else if (p.second->type() == MAP) {
+        else if (p.type == MAP) {
           s += "StringMap {";
-          StringMap map = ((MapObject*)p.second)->map_val;
+          const StringMap& map = p.map_val;
           int i = 0;
           for (std::pair<std::string,std::string> p : map) {
             s += "'" + p.first + "': '" + p.second + "'";
@@ -426,57 +441,90 @@ std::string SymbolTable::to_string() const
 // HELPER FUNCTIONS
 //----------------------------------------------------------------------
 
-void SymbolTable::delete_sym_obj(SymTableObject* obj)
+bool SymbolTable::name_exists_in_curr_env(const std::string& name) const
 {
-  if (!obj)
-    return;
-  else if (obj->type() == STR)
-    delete ((StrObject*)obj);
-  else if (obj->type() == MAP)
-    delete ((MapObject*)obj);
-  else if (obj->type() == VEC)
-    delete ((VecObject*)obj);
-  else if (obj->type() == VAL)
-    delete ((ValObject*)obj);
+  int slot = find_slot(name);
+  return slot != -1 and !env_base.empty() and slot >= (int)env_base.back();
 }
 
 
-bool SymbolTable::name_exists_in_curr_env(const std::string& name) const
+bool SymbolTable::name_exists_in_env(const std::string& name, int env_id) const
 {
-  return name_exists_in_env(name, current_environment_id);
+  // ids increase up the stack, so the environment is found by a binary
+  // search, and the name by following its chain of shadowed slots
+  auto env = std::lower_bound(env_ids.begin(), env_ids.end(), env_id);
+  if (env == env_ids.end() or *env != env_id)
+    return false;
+  size_t index = env - env_ids.begin();
+  int begin = env_base[index];
+  int end = index + 1 < env_base.size() ? env_base[index+1] : slots.size();
+  for (int slot = find_slot(name); slot >= begin; slot = slots[slot].shadowed)
+    if (slot < end)
+      return true;
+  return false;
 }
 
 
-bool SymbolTable::name_exists_in_env(const std::string& name, int env_id) const
+int SymbolTable::find_slot(const std::string& name) const
 {
-  for (std::pair<int,Environment> env_entry : environments) {
-    if (env_entry.first == env_id)
-      return env_entry.second.count(name) > 0;
-  }
-  return false;
+  auto it = innermost.find(name);
+  return it == innermost.end() ? -1 : it->second;
 }
 
 
-bool SymbolTable::get_env_for_name(const std::string& name, int& index) const
+const SymbolTable::Slot* SymbolTable::find(const std::string& name) const
 {
-  int curr_index = curr_env_index();
-  for (size_t i = curr_index + 1; i > 0; --i) {
-    if (environments[i-1].second.count(name) > 0) {
-      index = i - 1;
-      return true;
-    }
-  }
-  return false;
+  int slot = find_slot(name);
+  if (slot != -1)
+    return &slots[slot];
+  return parent ? parent->find_before(name, parent_names) : nullptr;
 }
 
-  
-int SymbolTable::curr_env_index() const
+
+const SymbolTable::Slot* SymbolTable::find_before(const std::string& name,
+                                                  size_t names) const
 {
-  for (int i = 0; i < environments.size(); ++i) {
-    if (current_environment_id == environments[i].first)
-      return i;
+  int slot = find_slot(name);
+  while (slot >= (int)names)
+    slot = slots[slot].shadowed;
+  return slot == -1 ? nullptr : &slots[slot];
+}
+
+
+const SymbolTable::Slot* SymbolTable::typed_slot(const std::string& name,
+                                                InfoType type) const
+{
+  const Slot* slot = find(name);
+  if (!slot or slot->type != type)
+    return nullptr;
+  return slot;
+}
+
+
+SymbolTable::Slot* SymbolTable::info_slot(const std::string& name, InfoType type)
+{
+  int slot = find_slot(name);
+  if (slot == -1)
+    return nullptr;
+  if (slots[slot].type != type) {
+    clear_info(slots[slot]);
+    slots[slot].type = type;
   }
-  return -1;
+  return &slots[slot];
+}
+
+
+void SymbolTable::clear_info(Slot& slot)
+{
+  if (slot.type == STR)
+    slot.str_val.clear();
+  else if (slot.type == VAL)
+    slot.obj_val.set_nil();
+  else if (slot.type == MAP)
+    slot.map_val.clear();
+  else if (slot.type == VEC)
+    slot.vec_val.clear();
+  slot.type = NONE;
 }
 
 
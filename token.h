@@ -9,7 +9,8 @@
 #define TOKEN_H
 
 #include <string>
-#include <map>
+#include <unordered_set>
+#include <type_traits>
 
 
 // MyPL allowable token types
@@ -48,9 +49,14 @@ public:
   // default constructor
   Token();
   
-  // constructor
+  // constructor (the lexeme is copied into the shared lexeme pool)
   Token(TokenType type, const std::string& lexeme, int line, int column);
 
+  // constructor (the lexeme is a span of characters that must outlive
+  // the token, such as the lexer's source buffer or a string literal)
+  Token(TokenType type, const char* lexeme_start, size_t lexeme_length,
+        int line, int column);
+
   // return the type of the token
   TokenType type() const;
 
@@ -74,14 +80,37 @@ public:
 
   // a string representation of the token object
   std::string to_string() const;
+
+  // token type to string representation (for printing)
+  static constexpr const char* TYPE_NAMES[] = {
+    // basic symbols
+    "ASSIGN", "COMMA", "DOT", "LPAREN", "RPAREN", "COLON",
+    // math operators
+    "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "MODULO", "NEG",
+    // logical operators
+    "AND", "OR", "NOT",
+    // comparators
+    "EQUAL", "GREATER", "GREATER_EQUAL", "LESS", "LESS_EQUAL", "NOT_EQUAL",
+    // reserved words
+    "TYPE", "WHILE", "FOR", "TO", "DO", "IF", "THEN", "ELSEIF", "ELSE",
+    "END", "FUN", "VAR", "RETURN", "NEW",
+    // primitive types
+    "BOOL_TYPE", "INT_TYPE", "DOUBLE_TYPE", "CHAR_TYPE", "STRING_TYPE",
+    // values
+    "BOOL_VAL", "INT_VAL", "DOUBLE_VAL", "STRING_VAL", "CHAR_VAL", "ID", "NIL",
+    // eos
+    "EOS"
+  };
   
 private:
 
   // the type of the token 
   TokenType token_type;
 
-  // the token's value in the program
-  std::string token_lexeme;
+  // the token's value in the program (a span of source or pooled
+  // characters, so tokens stay small and are trivially copyable)
+  const char* lexeme_start;
+  unsigned int lexeme_length;
 
   // the line location of the lexeme (starts at 1)
   int token_line;
@@ -89,55 +118,44 @@ private:
   // the column location of the start of the lexeme (starts at 1)
   int token_column;
 
-  // token type to string representation (for printing)
-  std::map<TokenType,std::string> token_type_map =
-    { // basic symbols
-	  // *** TODO *** 
-	  {ASSIGN, "ASSIGN"}, {COMMA, "COMMA"}, {DOT, "DOT"}, 
-	  {LPAREN, "LPAREN"}, {RPAREN, "RPAREN"}, {COLON, "COLON"},
-      // *** TODO *** 
-
-      // math operators
-      {PLUS, "PLUS"}, {MINUS, "MINUS"}, {MULTIPLY, "MULTIPLY"},
-      {DIVIDE, "DIVIDE"}, {MODULO, "MODULO"}, {NEG, "NEG"},
-      {STRING_VAL, "STRING_VAL"},
-      // logical operators
-      {AND, "AND"}, {OR, "OR"}, {NOT, "NOT"},
-      // comparators
-      {EQUAL, "EQUAL"}, {GREATER, "GREATER"},
-      {GREATER_EQUAL, "GREATER_EQUAL"}, {LESS, "LESS"},
-      {LESS_EQUAL, "LESS_EQUAL"}, {NOT_EQUAL, "NOT_EQUAL"},
-      // reserved words
-	  // *** TODO ***
-	  {TYPE, "TYPE"}, {WHILE, "WHILE"}, {FOR, "FOR"}, {TO, "TO"},
-	  {DO, "DO"}, {IF, "IF"}, {THEN, "THEN"}, {ELSEIF, "ELSEIF"},
-	  {ELSE, "ELSE"}, {END, "END"}, {FUN, "FUN"}, {VAR, "VAR"},
-	  {RETURN, "RETURN"}, {NEW, "NEW"},
-      // *** TODO ***
-
-      // primitive types
-      {BOOL_TYPE, "BOOL_TYPE"}, {INT_TYPE, "INT_TYPE"},
-      {DOUBLE_TYPE, "DOUBLE_TYPE"}, {CHAR_TYPE, "CHAR_TYPE"},
-      {STRING_TYPE, "STRING_TYPE"}, 
-      // values
-      {BOOL_VAL, "BOOL_VAL"}, {INT_VAL, "INT_VAL"},
-      {DOUBLE_VAL, "DOUBLE_VAL"}, {STRING_VAL, "STRING_VAL"},
-      {CHAR_VAL, "CHAR_VAL"}, {ID, "ID"}, {NIL, "NIL"},
-      // eos
-      {EOS, "EOS"}
-    };
+  // the characters of every distinct lexeme (never freed, so lexeme
+  // spans stay valid for the whole run)
+  static const char* intern(const std::string& lexeme);
 };
 
+constexpr const char* Token::TYPE_NAMES[];
+
+static_assert(sizeof(Token::TYPE_NAMES) / sizeof(Token::TYPE_NAMES[0]) == EOS + 1,
+              "missing token type name");
+static_assert(std::is_trivially_copyable<Token>::value,
+              "tokens are copied by value throughout the parser and AST");
+
+
+const char* Token::intern(const std::string& lexeme)
+{
+  static std::unordered_set<std::string> pool;
+  return pool.insert(lexeme).first->c_str();
+}
+
 
 Token::Token()
-  : token_type(EOS), token_lexeme(""), token_line(0), token_column(0)
+  : token_type(EOS), lexeme_start(""), lexeme_length(0), token_line(0),
+    token_column(0)
 {
 }
 
 
 Token::Token(TokenType type, const std::string& lexeme, int line, int column)
-  : token_type(type), token_lexeme(lexeme), token_line(line),
-    token_column(column)
+  : token_type(type), lexeme_start(intern(lexeme)),
+    lexeme_length(lexeme.size()), token_line(line), token_column(column)
+{
+}
+
+
+Token::Token(TokenType type, const char* lexeme_start, size_t lexeme_length,
+             int line, int column)
+  : token_type(type), lexeme_start(lexeme_start),
+    lexeme_length(lexeme_length), token_line(line), token_column(column)
 {
 }
 
@@ -150,7 +168,7 @@ TokenType Token::type() const
 
 std::string Token::lexeme() const
 {
-  return token_lexeme;
+  return std::string(lexeme_start, lexeme_length);
 }
 
 int Token::line() const
@@ -170,36 +188,32 @@ int Token::column() const
 
 bool Token::is_id() const
 {
-  if(token_type_map.find(token_type)->first == ID)
-    return true;
-  else
-    return false;
+  return token_type == ID;
 }
 
 std::string Token::get_type() const
 {
-  //if(token_type_map.find(token_type)->second)
-  if(token_type_map.find(token_type)->first == BOOL_VAL)
+  if(token_type == BOOL_VAL)
     return "bool";
-  else if(token_type_map.find(token_type)->first == INT_VAL)
+  else if(token_type == INT_VAL)
     return "int";
-  else if(token_type_map.find(token_type)->first == CHAR_VAL)
+  else if(token_type == CHAR_VAL)
     return "char";
-  else if(token_type_map.find(token_type)->first == STRING_VAL)
+  else if(token_type == STRING_VAL)
     return "string";
-  else if(token_type_map.find(token_type)->first == DOUBLE_VAL)
+  else if(token_type == DOUBLE_VAL)
     return "double";
-  else if(token_type_map.find(token_type)->first == NIL)
+  else if(token_type == NIL)
     return "nil";
-  else if(token_type_map.find(token_type)->first == ID)
-    return token_type_map.find(token_type)->second;
+  else if(token_type == ID)
+    return TYPE_NAMES[token_type];
   else
     return "Type not found in 'get_type()' function in Token.h";
 }
 
 std::string Token::to_string() const
 {
-  return token_type_map.find(token_type)->second +
+  return std::string(TYPE_NAMES[token_type]) +
     " '" + lexeme() + "' " +
     std::to_string(line()) + ":" + std::to_string(column());
 }
@@ -4,6 +4,14 @@
 // DATE: 3/22/2021
 // DESC: Implements a type checker within MYPL which decends through the AST
 //       and checks all function, type, and variable type compatability 
+//
+//       Given more than one thread, the checker first adds every type,
+//       function signature and parameter to the global environment (in
+//       order), then checks the function bodies concurrently. Each body
+//       gets its own symbol table over the read-only global one that
+//       sees only the global names declared before the body, so it is
+//       checked exactly as in one pass, and the error reported is the
+//       one the first failing declaration (in program order) raises.
 //----------------------------------------------------------------------
 
 
@@ -12,6 +20,11 @@
 
 #include <iostream>
 #include <list>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include "ast.h"
 #include "symbol_table.h"
 
@@ -20,6 +33,10 @@ class TypeChecker : public Visitor
 {
 public:
 
+  // create a type checker that checks function bodies on the given
+  // number of threads (sequentially, in one pass, if one)
+  TypeChecker(unsigned threads = 1) : threads(threads) {}
+
   // top-level
   void visit(Program& node);
   void visit(FunDecl& node);
@@ -47,12 +64,59 @@ private:
   // the symbol table 
   SymbolTable sym_table;
 
+  // the number of threads to check function bodies on
+  unsigned threads;
+
+  // an interned type: one id per primitive type and one per
+  // user-defined type name, so type checks compare integers
+  typedef int TypeId;
+  enum : TypeId {NIL_ID, BOOL_ID, INT_ID, DOUBLE_ID, CHAR_ID, STRING_ID};
+
+  // the name of each type id, and the id of each type name
+  std::vector<std::string> type_names {"nil", "bool", "int", "double",
+                                       "char", "string"};
+  std::unordered_map<std::string,TypeId> type_ids {
+    {"nil", NIL_ID}, {"bool", BOOL_ID}, {"int", INT_ID},
+    {"double", DOUBLE_ID}, {"char", CHAR_ID}, {"string", STRING_ID}};
+
   // the previously inferred type
-  std::string curr_type;
+  TypeId curr_type = NIL_ID;
+
+  // the field names of each user-defined type in offset order (shape)
+  std::unordered_map<std::string,StringVec> shapes;
+
+  // helpers to get the id of a type name or type token (interning
+  // names not seen before)
+  TypeId type_id(const std::string& name);
+  TypeId type_id(const Token& token);
+
+  // helpers to store and find the type of a variable (variable types
+  // are kept in the symbol table as int data objects)
+  void set_var_type(const std::string& name, TypeId type);
+  bool get_var_type(const std::string& name, TypeId& type) const;
+
+  // helper to apply the operator type rules of one level of an expression
+  void binary_type(Expr& node, TypeId lhs_type);
+
+  // helper to find the offset of a field within a type's shape
+  int field_offset(const std::string& type_name, const std::string& field);
 
   // helper to add built in functions
   void initialize_built_in_types();
 
+  // create a checker of function bodies over the global checker's
+  // types (each body is given its own table over the global one)
+  explicit TypeChecker(const TypeChecker* global);
+
+  // helpers to check the parts of a function declaration
+  void add_params(FunDecl& node);
+  void add_signature(FunDecl& node);
+  void check_body(FunDecl& node);
+
+  // helper to check the declarations with the function bodies checked
+  // concurrently
+  void check_decls_concurrently(Program& node);
+
   // error message
   void error(const std::string& msg, const Token& token);
   void error(const std::string& msg); 
@@ -72,6 +136,52 @@ void TypeChecker::error(const std::string& msg)
 }
 
 
+int TypeChecker::field_offset(const std::string& type_name, const std::string& field)
+{
+  const StringVec& shape = shapes[type_name];
+  for (size_t i = 0; i < shape.size(); ++i)
+    if (shape[i] == field)
+      return i;
+  return -1;
+}
+
+
+TypeChecker::TypeId TypeChecker::type_id(const std::string& name)
+{
+  auto entry = type_ids.emplace(name, type_names.size());
+  if (entry.second)
+    type_names.push_back(name);
+  return entry.first->second;
+}
+
+
+TypeChecker::TypeId TypeChecker::type_id(const Token& token)
+{
+  switch (token.type()) {
+    case NIL: return NIL_ID;
+    case BOOL_TYPE: case BOOL_VAL: return BOOL_ID;
+    case INT_TYPE: case INT_VAL: return INT_ID;
+    case DOUBLE_TYPE: case DOUBLE_VAL: return DOUBLE_ID;
+    case CHAR_TYPE: case CHAR_VAL: return CHAR_ID;
+    case STRING_TYPE: case STRING_VAL: return STRING_ID;
+    default: return type_id(token.lexeme());
+  }
+}
+
+
+void TypeChecker::set_var_type(const std::string& name, TypeId type)
+{
+  sym_table.set_val_info(name, DataObject(type));
+}
+
+
+bool TypeChecker::get_var_type(const std::string& name, TypeId& type) const
+{
+  const DataObject* val = sym_table.val_info(name);
+  return val and val->value(type);
+}
+
+
 void TypeChecker::initialize_built_in_types()
 {
   // print function
@@ -98,6 +208,9 @@ void TypeChecker::initialize_built_in_types()
   // read
   sym_table.add_name("read");
   sym_table.set_vec_info("read", StringVec {"string"});
+  // flush
+  sym_table.add_name("flush");
+  sym_table.set_vec_info("flush", StringVec {"nil"});
 }
 
 void TypeChecker::visit(Program& node)
@@ -108,17 +221,19 @@ void TypeChecker::visit(Program& node)
   // add built-in functions
   initialize_built_in_types();
  
-  for (Decl* d : node.decls)
-    d->accept(*this);
+  if(threads > 1)
+    check_decls_concurrently(node);
+  else
+    for (Decl* d : node.decls)
+      d->accept(*this);
     
   //check for main function
-  if(sym_table.name_exists("main") and sym_table.has_vec_info("main")) 
+  const StringVec* the_type = sym_table.vec_info("main");
+  if(the_type != nullptr) 
   {
-    StringVec the_type;
-    sym_table.get_vec_info("main", the_type);
-    std::string return_type = the_type[the_type.size()-1];
+    TypeId return_type = type_id(the_type->back());
     //check for return type and no params
-    if(return_type != "int" || the_type.size() != 1)
+    if(return_type != INT_ID || the_type->size() != 1)
       error("invalid 'main' function: a valid main function has a return type 'int' and no parameters");
   }
   
@@ -131,26 +246,43 @@ void TypeChecker::visit(Program& node)
 
 void TypeChecker::visit(FunDecl& node)
 {
-  //FUNCTION PARAMETERS AND RETURN TYPE
-  StringVec the_type;
-  
-  //to get parameters
+  add_params(node);
+  add_signature(node);
+  check_body(node);
+}
+
+
+//FUNCTION PARAMETERS (into the current environment)
+void TypeChecker::add_params(FunDecl& node)
+{
   for(auto vars = node.params.begin(); vars != node.params.end(); ++vars)
   {
   	sym_table.add_name(vars->id.lexeme());
-  	sym_table.set_str_info(vars->id.lexeme(), vars->type.lexeme());//add type to var name
-    the_type.push_back(vars->type.lexeme());
+  	set_var_type(vars->id.lexeme(), type_id(vars->type));//add type to var name
   }
+}
+
+
+//FUNCTION PARAMETER AND RETURN TYPES
+void TypeChecker::add_signature(FunDecl& node)
+{
+  StringVec the_type;
+  for(auto vars = node.params.begin(); vars != node.params.end(); ++vars)
+    the_type.push_back(vars->type.lexeme());
   
   the_type.push_back(node.return_type.lexeme());//add return type
   sym_table.add_name(node.id.lexeme());//add function name
   sym_table.set_vec_info(node.id.lexeme(), the_type);//add type and params
-  
+}
+
+
+//FUNCTION BODY
+void TypeChecker::check_body(FunDecl& node)
+{
   sym_table.push_environment();//push environment
   
-  //FUNCTION BODY
   sym_table.add_name("return");//add new return value for later checking
-  sym_table.set_str_info("return", node.return_type.lexeme());
+  set_var_type("return", type_id(node.return_type));
   
   //Continue to statements
   for(Stmt* s : node.stmts)
@@ -158,20 +290,96 @@ void TypeChecker::visit(FunDecl& node)
   
   sym_table.pop_environment();//pop it back
 }
+
+
+TypeChecker::TypeChecker(const TypeChecker* global)
+  : threads(1),
+    type_names(global->type_names), type_ids(global->type_ids),
+    shapes(global->shapes)
+{
+}
+
+
+void TypeChecker::check_decls_concurrently(Program& node)
+{
+  //first pass: the types and function signatures and parameters, in
+  //order, keeping the number of global names each body can see
+  //(stopping at the first declaration that fails)
+  std::vector<FunDecl*> funs;
+  std::vector<size_t> visible_names;
+  std::exception_ptr decl_error;
+  for (Decl* d : node.decls)
+  {
+    FunDecl* f = dynamic_cast<FunDecl*>(d);
+    try {
+      if (f)
+      {
+        add_params(*f);
+        add_signature(*f);
+      }
+      else
+        d->accept(*this);
+    } catch (...) {
+      decl_error = std::current_exception();
+      break;
+    }
+    if (f)
+    {
+      funs.push_back(f);
+      visible_names.push_back(sym_table.name_count());
+    }
+  }
+
+  //second pass: each worker takes the next unchecked body, keeping the
+  //error (if any) of each body by its position (and rethrowing it on
+  //this thread)
+  std::vector<std::exception_ptr> errors(funs.size());
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    TypeChecker checker(this);
+    for (size_t i = next++; i < funs.size(); i = next++)
+    {
+      try {
+        checker.sym_table = SymbolTable(&sym_table, visible_names[i]);
+        checker.check_body(*funs[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads and t < funs.size(); ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread& t : pool)
+    t.join();
+
+  //report the first error in program order (bodies checked all come
+  //before a failed declaration)
+  for (std::exception_ptr& e : errors)
+    if (e)
+      std::rethrow_exception(e);
+  if (decl_error)
+    std::rethrow_exception(decl_error);
+}
   
 //Type Declaration ex. Type Node {t1, t2, etc.}
 void TypeChecker::visit(TypeDecl& node)
 { 
   sym_table.add_name(node.id.lexeme()); //set the name of the UDT 
+  type_id(node.id.lexeme());//give the UDT its type id
   sym_table.push_environment();//push environment
   StringMap the_type;//init type decl map name
   sym_table.set_map_info(node.id.lexeme(), the_type);//create the empty map right now in case of same type within itself 
+  StringVec& shape = shapes[node.id.lexeme()];//fields are laid out in declaration order
+  shape.clear();
   
   for(VarDeclStmt* s : node.vdecls)//traverse ast
   {
     //take care of statements of type declaration
     s->accept(*this);
-    the_type[s->id.lexeme()] = curr_type;
+    the_type[s->id.lexeme()] = type_names[curr_type];
+    shape.push_back(s->id.lexeme());
   }
   
   sym_table.pop_environment();//pop
@@ -189,21 +397,21 @@ void TypeChecker::visit(VarDeclStmt& node)
   node.expr->accept(*this);//traverse to expression of vdcl
 
   //if explicitly defined and value is nil, still set type
-  if(node.type != nullptr && curr_type == "nil")
-    curr_type = node.type->lexeme();
+  if(node.type != nullptr && curr_type == NIL_ID)
+    curr_type = type_id(*node.type);
 
   //check if type matches expression for explicit functions
   if(node.type != nullptr)
-    if(node.type->lexeme() != curr_type && curr_type != "nil")
+    if(type_id(*node.type) != curr_type && curr_type != NIL_ID)
       error(node.type->location() + "VarDeclStmt Error: expression (rhs) does not match explicitly defined type");
 
   //if implicitly defined, cannot have value be nil
-  if(node.type == nullptr && curr_type == "nil")
+  if(node.type == nullptr && curr_type == NIL_ID)
       error("VarDeclStmt Error: Cannot implicitly define a variable to be a nil value");
 
 	//initialize variable info for symbol table
   std::string var_name = node.id.lexeme();
-  std::string expr_type = curr_type;
+  TypeId expr_type = curr_type;
 
 	//check if the variable is already defined in the current environment
   if(sym_table.name_exists_in_curr_env(var_name))
@@ -211,14 +419,14 @@ void TypeChecker::visit(VarDeclStmt& node)
 
   //Add variable to symbol table
   sym_table.add_name(var_name);
-  sym_table.set_str_info(var_name, expr_type);//add type to var name
+  set_var_type(var_name, expr_type);//add type to var name
 }
   
 //Assignment Statement ex. x = (1 + 2)
 void TypeChecker::visit(AssignStmt& node)
 {
 	//init variables
-  std::string prev_path_type;//keeps track of type of previous value in a path
+  TypeId prev_path_type = NIL_ID;//keeps track of type of previous value in a path
   int path_num = 1;//for counting position in path
   
   //Go through lhs variable. Could be a path too
@@ -226,24 +434,23 @@ void TypeChecker::visit(AssignStmt& node)
   {	
   		if(path_num == 1)//if on the first path item
   		{
-  		  if(sym_table.name_exists(t.lexeme()))//if the value is defined
-  				sym_table.get_str_info(t.lexeme(), curr_type);//get type of curr id
-  			else
+  		  //get type of curr id (checking if it is defined only if it is not a variable)
+  		  if(get_var_type(t.lexeme(), curr_type) == false && sym_table.info_type(t.lexeme()) == SymbolTable::UNDEFINED)
   				error(t.location() + "Var/Type " + t.lexeme() + " not found");
   		}
   		else//if there is a path
   		{
-  		  if(sym_table.has_map_info(prev_path_type) == false)//if it is the second value
+  		  const std::string& prev_type_name = type_names[prev_path_type];
+  		  const StringMap* fields = sym_table.map_info(prev_type_name);//get map info of previous type
+  		  if(fields == nullptr)//if it is the second value
   				error("ID Value does not exist");
-  				
-				StringMap map;//init map
-				sym_table.get_map_info(prev_path_type, map);//get map info of previous type
 				
 				//name of current path id should be the name of the previous path id's type
-				if(map.count(t.lexeme()) > 0)
-					curr_type = map[t.lexeme()];
-				else//type not found
+				auto field = fields->find(t.lexeme());
+				if(field == fields->end())//type not found
 					error(t.location() + "1 No type");
+				node.fields[path_num - 2] = field_offset(prev_type_name, t.lexeme());
+				curr_type = type_id(field->second);
   		}
   		
   	prev_path_type = curr_type;//update previous type
@@ -251,11 +458,11 @@ void TypeChecker::visit(AssignStmt& node)
   }
 
   //check to see if lhs matches rest of expression
-  std::string lhs_type = curr_type;
+  TypeId lhs_type = curr_type;
 	Expr* e = node.expr;
   e->accept(*this);
-  if(lhs_type != curr_type && curr_type != "nil")//if it doesnt match with rhs, error.
-    error(node.lvalue_list.front().location() + "LHS type " + lhs_type + " does not match rhs type" + curr_type);
+  if(lhs_type != curr_type && curr_type != NIL_ID)//if it doesnt match with rhs, error.
+    error(node.lvalue_list.front().location() + "LHS type " + type_names[lhs_type] + " does not match rhs type" + type_names[curr_type]);
 }
 
 //Return Statement
@@ -264,19 +471,18 @@ void TypeChecker::visit(ReturnStmt& node)
   Expr* e = node.expr;//traverse ast
   e->accept(*this);
   
-  std::string return_type;//init return type
+  TypeId return_type = NIL_ID;//init return type
 
   //Get the return type of the function
-  if(sym_table.has_str_info("return"))
-    sym_table.get_str_info("return", return_type);
+  get_var_type("return", return_type);
 
   //if return statement in nil function, error
   //if(return_type == "nil")
   //  error("No return statements needed in nil type function");
 
   //check for the type
-  if(curr_type != return_type && curr_type != "nil")
-    error("Function type [" + return_type + "] does not match returned type [" + curr_type + "]");
+  if(curr_type != return_type && curr_type != NIL_ID)
+    error("Function type [" + type_names[return_type] + "] does not match returned type [" + type_names[curr_type] + "]");
 }
 
 //IF/ IF ELSE Statements
@@ -287,7 +493,7 @@ void TypeChecker::visit(IfStmt& node)
   Expr* e = node.if_part->expr;
   e->accept(*this);
   
-  if(curr_type != "bool")//check to see if conditions are boolean
+  if(curr_type != BOOL_ID)//check to see if conditions are boolean
   	error("If statement conditions need to be boolean type");//25
   
 	//body statements 
@@ -303,7 +509,7 @@ void TypeChecker::visit(IfStmt& node)
   	Expr* e = b->expr;
   	e->accept(*this);
   	
-  	if(curr_type != "bool")//check to see if conditions are boolean
+  	if(curr_type != BOOL_ID)//check to see if conditions are boolean
   		error("If statement conditions need to be boolean type");//26
   		
   	//body statements
@@ -330,7 +536,7 @@ void TypeChecker::visit(WhileStmt& node)
   Expr* e = node.expr;//go through ast
   e->accept(*this);
   
-  if(curr_type != "bool")//check to see if conditions are boolean
+  if(curr_type != BOOL_ID)//check to see if conditions are boolean
   	error("While statement conditions need to be boolean type");//24
   
   //body statements
@@ -351,18 +557,18 @@ void TypeChecker::visit(ForStmt& node)
 
 	//add for loop parameter variable to symbol table
 	std::string var_name = node.var_id.lexeme();
-	std::string expr_type = curr_type;
+	TypeId expr_type = curr_type;
 	sym_table.add_name(var_name);
-	sym_table.set_str_info(var_name, expr_type);//add type to var name
+	set_var_type(var_name, expr_type);//add type to var name
 
-  if(curr_type != "int")//check to see if conditions are boolean
+  if(curr_type != INT_ID)//check to see if conditions are boolean
   	error(node.var_id.location() + "For statement conditions need to be int type");//27
   	
   //body statements	
   Expr* n = node.end;
   n->accept(*this);
   
-  if(curr_type != "int")//check to see if conditions are boolean
+  if(curr_type != INT_ID)//check to see if conditions are boolean
   	error(node.var_id.location() + "For statement conditions need to be int type");//27
   
 	//body statements
@@ -377,84 +583,98 @@ void TypeChecker::visit(ForStmt& node)
 // expressions
 void TypeChecker::visit(Expr& node)
 {
-  //Left hand side of expression
-  ExprTerm* e = node.first;
-  e->accept(*this);
+  //collect the chain of left operands (innermost last)
+  std::vector<Expr*> chain;
+  for(Expr* e = &node; e != nullptr; e = e->left_expr())
+    chain.push_back(e);
 
-  std::string lhs_type = curr_type; //keep copy of the current type
+  //Left hand side of the innermost expression
+  chain.back()->first->accept(*this);
 
-  if(node.rest)//Right part of the expression
+  //then check each operator (innermost first) against the type so far
+  for(auto it = chain.rbegin(); it != chain.rend(); ++it)
   {
-  	Expr* ex = node.rest;
-  	ex->accept(*this);
+    Expr* ex = *it;
+    TypeId lhs_type = curr_type; //keep copy of the current type
+
+    if(ex->rest)//Right part of the expression
+    {
+      ex->rest->accept(*this);
+      binary_type(*ex, lhs_type);
+    }
+
+    //Extra check for negated boolean value. If it is type boolean
+    if(ex->negated == true && curr_type != BOOL_ID)
+    {
+      error("Cannot negate (NOT) non-bool expressions");//23
+    }
   }
+}
 
+
+void TypeChecker::binary_type(Expr& node, TypeId lhs_type)
+{
 	//Very large check of all type rules
   if(node.op != nullptr)
   {
+    TokenType op = node.op->type();
+
     //Math operators
-    if((node.op->lexeme() == "+" || node.op->lexeme() == "-") || (node.op->lexeme() == "*" || node.op->lexeme() == "/"))//for math operators
+    if(op == PLUS || op == MINUS || op == MULTIPLY || op == DIVIDE)//for math operators
     {
-      if(node.op->lexeme() == "+" && (lhs_type == "char" || lhs_type == "string"))//char/string concatination
+      if(op == PLUS && (lhs_type == CHAR_ID || lhs_type == STRING_ID))//char/string concatination
       {
-      	if(curr_type == "char" || curr_type == "string")
-      		curr_type = "string";
+      	if(curr_type == CHAR_ID || curr_type == STRING_ID)
+      		curr_type = STRING_ID;
       	else
       		error("Concatination has to be between strings and chars");
       }
-      else if((lhs_type == "int" && curr_type == "int"))//if int on lhs, then int on rhs is needed
-        curr_type = "int";
-      else if((lhs_type == "double" && curr_type == "double"))//if double on lhs, then double on rhs is needed 
-        curr_type = "double";
+      else if((lhs_type == INT_ID && curr_type == INT_ID))//if int on lhs, then int on rhs is needed
+        curr_type = INT_ID;
+      else if((lhs_type == DOUBLE_ID && curr_type == DOUBLE_ID))//if double on lhs, then double on rhs is needed 
+        curr_type = DOUBLE_ID;
       else
         	error("Expressions with +,-,*,/ need to be (int [op] int) or (double [op] double)");
     }
     
     //Comparison operators
-    else if((node.op->lexeme() == "<" || node.op->lexeme() == ">") 
-    || (node.op->lexeme() == ">=" || node.op->lexeme() == "<="))
+    else if(op == LESS || op == GREATER || op == GREATER_EQUAL || op == LESS_EQUAL)
     {
-      if((lhs_type == "int" && curr_type == "int") || (lhs_type == "double" && curr_type == "double") //check for matching types in comparison
-      || (lhs_type == "char" && curr_type == "char") || (lhs_type == "string" && curr_type == "string"))
-        curr_type = "bool";
+      if(lhs_type == curr_type && (lhs_type == INT_ID || lhs_type == DOUBLE_ID //check for matching types in comparison
+      || lhs_type == CHAR_ID || lhs_type == STRING_ID))
+        curr_type = BOOL_ID;
       else
         error("Cannot use >,>=,<,<= operators in expressions without matching double/int/char/string vals" + node.op->location());
     }
     
     //MOD operator
-    else if(node.op->lexeme() == "%")//mod operations 
+    else if(op == MODULO)//mod operations 
     {
-      if((lhs_type == "int" && curr_type == "int"))//if int on lhs, then int on rhs is needed
-        curr_type = "int";
+      if((lhs_type == INT_ID && curr_type == INT_ID))//if int on lhs, then int on rhs is needed
+        curr_type = INT_ID;
       else 
         error("Use of MOD % needs to be int on lhs and rhs");
     }
     
     //Boolean && || operations
-    else if(node.op->lexeme() == "or" || node.op->lexeme() == "and")
+    else if(op == OR || op == AND)
     {
-      if(lhs_type != "bool" || curr_type != "bool")
+      if(lhs_type != BOOL_ID || curr_type != BOOL_ID)
       	error("'or' and 'and' operators can only be used with boolean expressions");//21,22
     }
     
     //Equivalence operations
-    else if(node.op->lexeme() == "==" || node.op->lexeme() == "!=")//17, 18, 19
+    else if(op == EQUAL || op == NOT_EQUAL)//17, 18, 19
     {
       if(lhs_type != curr_type)//check if the type types match or if one of them is nil
       {
-      	if(lhs_type != "nil" && curr_type != "nil")
+      	if(lhs_type != NIL_ID && curr_type != NIL_ID)
       		error("'' and '' comparisons need to be between two matching types or nils");
       }
-      curr_type = "bool"; 	
+      curr_type = BOOL_ID; 	
     }
 
   }
-
-	//Extra check for negated boolean value. If it is type boolean
-	if(node.negated == true && curr_type != "bool")
-  {
-    	error("Cannot negate (NOT) non-bool expressions");//23
-  }    
 }
 
 //Simple Term: simple value, call expr, new value, idr val, negated value
@@ -474,16 +694,16 @@ void TypeChecker::visit(ComplexTerm& node)
 // Simple Value ex. "5"
 void TypeChecker::visit(SimpleRValue& node)
 {
-  curr_type = node.value.get_type();
+  curr_type = type_id(node.value);
 }
 
 //New RHS Value ex. var x = "new Node"
 void TypeChecker::visit(NewRValue& node)
 {
-  curr_type = node.type_id.lexeme();//set current type
+  curr_type = type_id(node.type_id);//set current type
 
   //check to see if user defined type exists
-  if(sym_table.has_map_info(curr_type) == false)
+  if(sym_table.map_info(type_names[curr_type]) == nullptr)
     error(node.type_id.location() + "User defined type doesn't exist");
 }
 
@@ -492,15 +712,14 @@ void TypeChecker::visit(CallExpr& node)
 {
   //Get the info from the ast
   std::string fun_name = node.function_id.lexeme();
-  StringVec fun_type;
-  sym_table.get_vec_info(fun_name, fun_type);
+  const StringVec* fun_type = sym_table.vec_info(fun_name);//the signature (args cannot add names, so it stays valid)
   
   //check for function name existance
-  if(sym_table.name_exists(fun_name) == false)//check for function
+  if(fun_type == nullptr && sym_table.info_type(fun_name) == SymbolTable::UNDEFINED)//check for function
   	error("Function " + fun_name + " does not exist");
   
   //check for correct number of parameters
-  if(fun_type.size()-1 != node.arg_list.size())//check for param sizes
+  if(fun_type == nullptr || fun_type->size()-1 != node.arg_list.size())//check for param sizes
   	error("Incorrect number of function params");
   
   //Check for matching parameter types
@@ -508,19 +727,19 @@ void TypeChecker::visit(CallExpr& node)
   for(Expr* x : node.arg_list)
   {
   	x->accept(*this);
-  	if(fun_type[i] != curr_type && curr_type != "nil")
+  	if(type_id((*fun_type)[i]) != curr_type && curr_type != NIL_ID)
   		error(node.function_id.location() + "Mismatched function call");//15
   	++i;
   }
   
-  curr_type = fun_type[fun_type.size()-1];//set curr type to return type
+  curr_type = type_id(fun_type->back());//set curr type to return type
 }
 
 //RHS ID value 
 void TypeChecker::visit(IDRValue& node)
 {
 	//set up values for a path
-  std::string prev_path_type;
+  TypeId prev_path_type = NIL_ID;
   int path_num = 1;
   
   //Go through path
@@ -528,25 +747,24 @@ void TypeChecker::visit(IDRValue& node)
   {	
   		if(path_num == 1)//if on the first path item
   		{
-  		  if(sym_table.name_exists(t.lexeme()))//if the value is defined
-  				sym_table.get_str_info(t.lexeme(), curr_type);
-  			else
+  		  //get type of curr id (checking if it is defined only if it is not a variable)
+  		  if(get_var_type(t.lexeme(), curr_type) == false && sym_table.info_type(t.lexeme()) == SymbolTable::UNDEFINED)
   				error(t.location() + "Var/Type " + t.lexeme() + " not found");
   		}
   		else//if there is a path
   		{
-  		  if(sym_table.has_map_info(prev_path_type) == false)//if it is the second value
+  		  const std::string& prev_type_name = type_names[prev_path_type];
+  			//get the field types of the previous path id's type to check if matching
+  		  const StringMap* fields = sym_table.map_info(prev_type_name);
+  		  if(fields == nullptr)//if it is the second value
   				error("ID Value does not exist");
-  			
-  			//create new map value to get type of previous path id to check if matching	
-				StringMap map;
-				sym_table.get_map_info(prev_path_type, map);
 				
 				//Check to see if current path value exists
-				if(map.count(t.lexeme()) > 0)//if exists
-					curr_type = map[t.lexeme()];
-				else
+				auto field = fields->find(t.lexeme());
+				if(field == fields->end())
 					error(t.location() + "1 No type");
+				node.fields[path_num - 2] = field_offset(prev_type_name, t.lexeme());//offset within the shape
+				curr_type = type_id(field->second);
   		}
   		
   	//update type and path position
@@ -563,7 +781,7 @@ void TypeChecker::visit(NegatedRValue& node)
   e->accept(*this);
 
   //check to see if the type is an int or double
-  if(curr_type != "int" && curr_type != "double")
+  if(curr_type != INT_ID && curr_type != DOUBLE_ID)
     error("Cannot negate non int/double values");
 }
 
@@ -0,0 +1,564 @@
+//----------------------------------------------------------------------
+// NAME: Wesley Muehlhausen
+// FILE: vm.h
+// DATE: Oct 16, 2026
+// DESC: Virtual machine for MyPL register bytecode. Calls push a frame
+//       onto an explicit frame stack (the callee's register window
+//       starts at the caller's argument registers), so MyPL recursion
+//       does not recurse in C++, and a call in tail position replaces
+//       the caller's frame. Dispatch uses computed gotos when the
+//       compiler supports them and a switch otherwise.
+//----------------------------------------------------------------------
+
+#ifndef VM_H
+#define VM_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+#include "data_object.h"
+#include "heap.h"
+#include "output.h"
+
+#if defined(__GNUC__)
+#define MYPL_COMPUTED_GOTO
+#endif
+
+
+class VM
+{
+public:
+
+  // create a vm for running the given module
+  VM(const Module& module) : module(module) {}
+
+  // run the main function of the module
+  void run();
+
+  // return code from calling main
+  int return_code() const;
+
+  // garbage collection statistics
+  std::string gc_stats() const;
+
+private:
+
+  // a function activation
+  struct Frame {
+    const Chunk* chunk;         // code being executed
+    const Instr* ip;            // where to resume after a call
+    size_t base;                // start of the register window
+  };
+
+  // the program being run
+  const Module& module;
+
+  // the register file (all windows) and the frame stack
+  std::vector<DataObject> regs;
+  std::vector<Frame> frames;
+
+  // the heap and the next oid
+  Heap heap;
+  size_t next_oid = 0;
+
+  // program output (written by print, flushed at the end and before reads)
+  Output output;
+
+  // the program return code
+  int ret_code = 0;
+
+  // operator helpers
+  void arith(int op, const DataObject& lhs, const DataObject& rhs,
+             DataObject& result);
+  bool compare(int op, const DataObject& lhs, const DataObject& rhs);
+  void logic(int op, const DataObject& lhs, const DataObject& rhs,
+             DataObject& result);
+
+  // built-in functions (arguments start at args, result in args[0])
+  void built_in(int id, DataObject* args);
+
+  // make sure the register file can hold the given window
+  void reserve(size_t base, int num_regs);
+
+  // user-defined type helpers
+  size_t oid_of(const DataObject& obj);
+  DataObject& field_of(const DataObject& obj, int field);
+
+  // free the heap objects that no live register can reach
+  void collect_garbage();
+
+  // error message
+  void error(const std::string& msg);
+};
+
+
+int VM::return_code() const
+{
+  return ret_code;
+}
+
+
+std::string VM::gc_stats() const
+{
+  return heap.stats();
+}
+
+
+void VM::error(const std::string& msg)
+{
+  throw MyPLException(RUNTIME, msg);
+}
+
+
+//----------------------------------------------------------------------
+// HELPER FUNCTIONS
+//----------------------------------------------------------------------
+
+void VM::reserve(size_t base, int num_regs)
+{
+  size_t needed = base + num_regs;
+  if (regs.size() < needed)
+    regs.resize(std::max(needed, regs.size() * 2));
+}
+
+
+size_t VM::oid_of(const DataObject& obj)
+{
+  size_t oid = 0;
+  if (!obj.value(oid))
+    error("attempt to access a field of a nil value");
+  return oid;
+}
+
+
+// the given field of the object, updated in place
+DataObject& VM::field_of(const DataObject& obj, int field)
+{
+  return heap.get_obj(oid_of(obj))->field(field);
+}
+
+
+// the roots are the register windows of the active frames (registers
+// above the top window only hold values of returned calls)
+void VM::collect_garbage()
+{
+  size_t top = 0;
+  for (const Frame& frame : frames)
+    top = std::max(top, frame.base + frame.chunk->num_regs);
+  for (size_t r = 0; r < top; ++r)
+    heap.mark(regs[r]);
+  heap.sweep();
+}
+
+
+void VM::arith(int op, const DataObject& lhs, const DataObject& rhs,
+               DataObject& result)
+{
+  if (lhs.is_integer() and rhs.is_integer()) {
+    int l, r;
+    lhs.value(l);
+    rhs.value(r);
+    if (op == OP_ADD) result.set(l + r);
+    else if (op == OP_SUB) result.set(l - r);
+    else if (op == OP_MUL) result.set(l * r);
+    else if (op == OP_DIV) result.set(l / r);
+    else result.set(l % r);
+  }
+  else if (op == OP_MOD)
+    error("mod operator error");
+  else if (lhs.is_double() and rhs.is_double()) {
+    double l, r;
+    lhs.value(l);
+    rhs.value(r);
+    if (op == OP_ADD) result.set(l + r);
+    else if (op == OP_SUB) result.set(l - r);
+    else if (op == OP_MUL) result.set(l * r);
+    else result.set(l / r);
+  }
+  else if (op != OP_ADD)
+    error("Simple Arithmetic Error");
+  // char and string concatenation
+  else if ((lhs.is_char() or lhs.is_string()) and
+           (rhs.is_char() or rhs.is_string())) {
+    std::string s = lhs.is_char() ? std::string(1, ' ') : std::string();
+    char c;
+    if (lhs.value(c))
+      s[0] = c;
+    else
+      lhs.value(s);
+    if (rhs.value(c))
+      s += c;
+    else {
+      std::string r;
+      rhs.value(r);
+      s += r;
+    }
+    result.set(s);
+  }
+  else
+    error("unable to add expressions provided");
+}
+
+
+bool VM::compare(int op, const DataObject& lhs, const DataObject& rhs)
+{
+  // equality is defined for nil and objects, ordering is not
+  if (op == OP_EQ or op == OP_NE) {
+    bool equal = false;
+    if (lhs.is_nil() or rhs.is_nil())
+      equal = lhs.is_nil() and rhs.is_nil();
+    else if (lhs.type() != rhs.type())
+      error("Expression Equivalence operator error of L: " +
+            lhs.to_string() + " R; " + rhs.to_string());
+    else if (lhs.is_string()) {
+      std::string l, r;
+      lhs.value(l);
+      rhs.value(r);
+      equal = l == r;
+    }
+    else if (lhs.is_double()) {
+      double l = 0, r = 0;
+      lhs.value(l);
+      rhs.value(r);
+      equal = l == r;
+    }
+    else {
+      // int, char, bool and oid values compare by their bits
+      size_t l = 0, r = 0;
+      int il = 0, ir = 0;
+      char cl = 0, cr = 0;
+      bool bl = false, br = false;
+      if (lhs.value(il)) { rhs.value(ir); equal = il == ir; }
+      else if (lhs.value(cl)) { rhs.value(cr); equal = cl == cr; }
+      else if (lhs.value(bl)) { rhs.value(br); equal = bl == br; }
+      else { lhs.value(l); rhs.value(r); equal = l == r; }
+    }
+    return op == OP_EQ ? equal : !equal;
+  }
+  int cmp = 0;
+  if (lhs.type() != rhs.type() or lhs.is_nil() or lhs.is_oid())
+    error("Unable to compute comparison operation");
+  else if (lhs.is_integer()) {
+    int l, r;
+    lhs.value(l);
+    rhs.value(r);
+    cmp = (l > r) - (l < r);
+  }
+  else if (lhs.is_double()) {
+    double l, r;
+    lhs.value(l);
+    rhs.value(r);
+    cmp = (l > r) - (l < r);
+  }
+  else if (lhs.is_char()) {
+    char l, r;
+    lhs.value(l);
+    rhs.value(r);
+    cmp = (l > r) - (l < r);
+  }
+  else if (lhs.is_bool()) {
+    bool l, r;
+    lhs.value(l);
+    rhs.value(r);
+    cmp = (l > r) - (l < r);
+  }
+  else {
+    std::string l, r;
+    lhs.value(l);
+    rhs.value(r);
+    cmp = l.compare(r);
+  }
+  if (op == OP_LT) return cmp < 0;
+  if (op == OP_LE) return cmp <= 0;
+  if (op == OP_GT) return cmp > 0;
+  return cmp >= 0;
+}
+
+
+void VM::logic(int op, const DataObject& lhs, const DataObject& rhs,
+               DataObject& result)
+{
+  bool l = false, r = false;
+  lhs.value(l);
+  rhs.value(r);
+  result.set(op == OP_AND ? (l and r) : (l or r));
+}
+
+
+void VM::built_in(int id, DataObject* args)
+{
+  if (id == BI_PRINT)
+    output.write(args[0].to_string());
+  else if (id == BI_ITOS) {
+    int val = 0;
+    args[0].value(val);
+    args[0].set(std::to_string(val));
+  }
+  else if (id == BI_DTOS) {
+    double val = 0;
+    args[0].value(val);
+    args[0].set(std::to_string(val));
+  }
+  else if (id == BI_STOI) {
+    std::string in;
+    args[0].value(in);
+    args[0].set(std::stoi(in));
+  }
+  else if (id == BI_STOD) {
+    std::string in;
+    args[0].value(in);
+    args[0].set(std::stod(in));
+  }
+  else if (id == BI_LENGTH) {
+    std::string in;
+    args[0].value(in);
+    args[0].set((int)in.length());
+  }
+  else if (id == BI_GET) {
+    int index = 0;
+    std::string input;
+    args[0].value(index);
+    args[1].value(input);
+    if (input.length() == 0)
+      error("get() function requires string size greater than 0");
+    if (index < 0 or (size_t)index >= input.length())
+      error("invalid index provided for get() function");
+    args[0].set(input.at(index));
+  }
+  else if (id == BI_READ) {
+    std::string in;
+    output.flush();
+    std::cin >> in;
+    args[0].set(in);
+  }
+  else if (id == BI_FLUSH) {
+    output.flush();
+    args[0].set_nil();
+  }
+}
+
+
+//----------------------------------------------------------------------
+// THE INTERPRETER LOOP
+//----------------------------------------------------------------------
+
+void VM::run()
+{
+  const Chunk* chunk = &module.chunks[module.main_chunk];
+  const DataObject* K = module.constants.data();
+  size_t base = 0;
+  reserve(base, chunk->num_regs);
+  frames.push_back(Frame {chunk, nullptr, base});
+  DataObject* R = regs.data();
+  const Instr* ip = chunk->code.data();
+  const Instr* i = nullptr;
+
+#ifdef MYPL_COMPUTED_GOTO
+  // must match the order of the OpCode enum
+  static void* dispatch_table[] = {
+    &&L_MOVE, &&L_LOADK, &&L_LOADNIL, &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV,
+    &&L_MOD, &&L_ADDI, &&L_LT, &&L_LE, &&L_GT, &&L_GE, &&L_EQ, &&L_NE,
+    &&L_AND, &&L_OR, &&L_NOT, &&L_NEG, &&L_JMP, &&L_JMPF, &&L_JNLT,
+    &&L_JNLE, &&L_JNGT, &&L_JNGE, &&L_JNEQ, &&L_JNNE, &&L_FORLOOP,
+    &&L_CALL, &&L_TAILCALL, &&L_BUILTIN, &&L_RET, &&L_RETNIL, &&L_MKOBJ,
+    &&L_GETF, &&L_SETF
+  };
+  static_assert(sizeof(dispatch_table) / sizeof(dispatch_table[0]) == OP_COUNT,
+                "missing opcode in dispatch table");
+#define DISPATCH() goto *dispatch_table[(i = ip++)->op]
+#define CASE(name) L_##name:
+  DISPATCH();
+#else
+#define DISPATCH() continue
+#define CASE(name) case OP_##name:
+  for (;;) {
+  i = ip++;
+  switch (i->op) {
+#endif
+
+  CASE(MOVE) {
+    R[i->a] = R[i->b];
+    DISPATCH();
+  }
+  CASE(LOADK) {
+    R[i->a] = K[i->b];
+    DISPATCH();
+  }
+  CASE(LOADNIL) {
+    R[i->a].set_nil();
+    DISPATCH();
+  }
+  CASE(ADD)
+  CASE(SUB)
+  CASE(MUL)
+  CASE(DIV)
+  CASE(MOD) {
+    arith(i->op, R[i->b], R[i->c], R[i->a]);
+    DISPATCH();
+  }
+  CASE(ADDI) {
+    int val;
+    if (!R[i->b].value(val))
+      error("unable to add expressions provided");
+    R[i->a].set(val + i->c);
+    DISPATCH();
+  }
+  CASE(LT)
+  CASE(LE)
+  CASE(GT)
+  CASE(GE)
+  CASE(EQ)
+  CASE(NE) {
+    R[i->a].set(compare(i->op, R[i->b], R[i->c]));
+    DISPATCH();
+  }
+  CASE(AND)
+  CASE(OR) {
+    logic(i->op, R[i->b], R[i->c], R[i->a]);
+    DISPATCH();
+  }
+  CASE(NOT) {
+    bool val = false;
+    R[i->b].value(val);
+    R[i->a].set(!val);
+    DISPATCH();
+  }
+  CASE(NEG) {
+    int int_val;
+    double double_val;
+    if (R[i->b].value(int_val))
+      R[i->a].set(-int_val);
+    else if (R[i->b].value(double_val))
+      R[i->a].set(-double_val);
+    else
+      error("Cannot negate non double/int expressions");
+    DISPATCH();
+  }
+  CASE(JMP) {
+    ip = chunk->code.data() + i->a;
+    DISPATCH();
+  }
+  CASE(JMPF) {
+    bool val = false;
+    R[i->a].value(val);
+    if (!val)
+      ip = chunk->code.data() + i->b;
+    DISPATCH();
+  }
+  CASE(JNLT)
+  CASE(JNLE)
+  CASE(JNGT)
+  CASE(JNGE)
+  CASE(JNEQ)
+  CASE(JNNE) {
+    const DataObject& lhs = R[i->a];
+    const DataObject& rhs = R[i->b];
+    bool taken;
+    int l, r;
+    if (lhs.value(l) and rhs.value(r)) {
+      switch (i->op) {
+        case OP_JNLT: taken = !(l < r); break;
+        case OP_JNLE: taken = !(l <= r); break;
+        case OP_JNGT: taken = !(l > r); break;
+        case OP_JNGE: taken = !(l >= r); break;
+        case OP_JNEQ: taken = !(l == r); break;
+        default: taken = !(l != r); break;
+      }
+    }
+    else
+      taken = !compare(i->op - OP_JNLT + OP_LT, lhs, rhs);
+    if (taken)
+      ip = chunk->code.data() + i->c;
+    DISPATCH();
+  }
+  CASE(FORLOOP) {
+    int counter = 0, end = 0;
+    R[i->a].value(counter);
+    R[i->b].value(end);
+    ++counter;
+    R[i->a].set(counter);
+    if (counter <= end)
+      ip = chunk->code.data() + i->c;
+    DISPATCH();
+  }
+  CASE(CALL) {
+    const Chunk* callee = &module.chunks[i->b];
+    frames.back().ip = ip;
+    base += i->a;
+    reserve(base, callee->num_regs);
+    frames.push_back(Frame {callee, nullptr, base});
+    chunk = callee;
+    R = regs.data() + base;
+    ip = chunk->code.data();
+    DISPATCH();
+  }
+  CASE(TAILCALL) {
+    // the arguments replace the caller's window, so a chain of tail
+    // calls runs in one frame
+    const Chunk* callee = &module.chunks[i->b];
+    for (int k = 0; k < i->c; ++k)
+      R[k] = std::move(R[i->a + k]);
+    reserve(base, callee->num_regs);
+    frames.back().chunk = callee;
+    chunk = callee;
+    R = regs.data() + base;
+    ip = chunk->code.data();
+    DISPATCH();
+  }
+  CASE(BUILTIN) {
+    built_in(i->b, R + i->a);
+    DISPATCH();
+  }
+  CASE(RET)
+  CASE(RETNIL) {
+    // the result goes to the first register of the window, which is
+    // the caller's destination register
+    if (i->op == OP_RETNIL)
+      R[0].set_nil();
+    else if (i->a != 0)
+      R[0] = std::move(R[i->a]);
+    frames.pop_back();
+    if (frames.empty())
+      goto done;
+    chunk = frames.back().chunk;
+    ip = frames.back().ip;
+    base = frames.back().base;
+    R = regs.data() + base;
+    DISPATCH();
+  }
+  CASE(MKOBJ) {
+    if (heap.needs_collection())
+      collect_garbage();
+    const TypeLayout& layout = module.types[i->b];
+    HeapObject obj(layout.fields.size());
+    for (size_t f = 0; f < layout.fields.size(); ++f)
+      obj.set_att(f, R[f]);
+    size_t oid = next_oid++;
+    heap.set_obj(oid, std::move(obj));
+    R[i->a].set(oid);
+    DISPATCH();
+  }
+  CASE(GETF) {
+    R[i->a] = field_of(R[i->b], i->c);
+    DISPATCH();
+  }
+  CASE(SETF) {
+    field_of(R[i->a], i->b) = R[i->c];
+    DISPATCH();
+  }
+
+#ifndef MYPL_COMPUTED_GOTO
+  }
+  }
+#endif
+#undef DISPATCH
+#undef CASE
+
+ done:
+  output.write('\n');//for aesthetic purposes
+  output.flush();
+}
+
+
+#endif